@@ -0,0 +1,405 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has mockKite, a local stand-in for the Kite REST API that the REST benchmarks are run against
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+#include "kitepp/kite.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// configuration of mockKite
+struct mockKiteConfig {
+
+    std::chrono::microseconds latency { 0 }; // added to every response
+    std::chrono::microseconds jitter { 0 };  // up to this much more latency is added at random
+    double errorRate = 0.0;                  // fraction of requests answered with a 500 GeneralException
+    size_t records = 50;    // orders, trades, positions, holdings, GTTs, candles and instruments in list responses
+    size_t threads = 16;    // server threads. A keep-alive connection holds a thread while it's open
+    string certPath = "";   // serve over TLS if set
+    string keyPath = "";
+};
+
+/**
+ * @brief Local stand-in for the Kite REST API, built on `httplib::Server`.
+ *
+ * Serves the paths of `kite::_endpoints` (user, orders, trades, portfolio, quotes, instruments, historical data, GTTs
+ * and margins) with canned responses of `records` entries. Responses are built once, so the server adds little work of
+ * its own to the requests being measured. Point a kite at it with:
+ *
+ *     Kite.setTransport(std::make_unique<kc::httpTransport>(mock.getURL()));
+ */
+class mockKite {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new mockKite object
+     *
+     * @param config
+     */
+    explicit mockKite(mockKiteConfig config = {}): _config(std::move(config)) {
+
+        _server = (_config.certPath.empty()) ?
+                      std::make_unique<httplib::Server>() :
+                      std::make_unique<httplib::SSLServer>(_config.certPath.c_str(), _config.keyPath.c_str());
+        const size_t threads = _config.threads;
+        _server->new_task_queue = [threads]() { return new httplib::ThreadPool(threads); };
+        _server->set_keep_alive_max_count(1000000);
+        _server->set_tcp_nodelay(true);
+
+        _buildPayloads();
+        _route();
+    };
+
+    mockKite(const mockKite&) = delete;
+    mockKite& operator=(const mockKite&) = delete;
+
+    ~mockKite() { stop(); };
+
+    // methods
+
+    /**
+     * @brief start serving on a free port of host
+     *
+     * @param host
+     *
+     * @return int port
+     */
+    int start(const string& host = "127.0.0.1") {
+
+        _host = host;
+        _port = _server->bind_to_any_port(host.c_str());
+        if (_port < 0) { throw libException(FMT("Failed to bind to {0} (mockKite)", host)); };
+        _thread = std::thread([this]() { _server->listen_after_bind(); });
+
+        return _port;
+    };
+
+    /**
+     * @brief stop serving
+     *
+     */
+    void stop() {
+
+        _server->stop();
+        if (_thread.joinable()) { _thread.join(); };
+    };
+
+    /**
+     * @brief get the root URL to pass to `httpTransport`
+     *
+     * @return string
+     */
+    string getURL() const { return FMT("{0}://{1}:{2}", (_config.certPath.empty()) ? "http" : "https", _host, _port); };
+
+    /**
+     * @brief get number of requests served, including failed ones
+     *
+     * @return uint64_t
+     */
+    uint64_t getRequestCount() const { return _requests.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief get number of requests answered with an injected error
+     *
+     * @return uint64_t
+     */
+    uint64_t getErrorCount() const { return _errors.load(std::memory_order_relaxed); };
+
+  private:
+    using _handler = std::function<void(const httplib::Request&, httplib::Response&)>;
+
+    // member variables
+
+    mockKiteConfig _config;
+    std::unique_ptr<httplib::Server> _server;
+    std::thread _thread;
+    string _host;
+    int _port = -1;
+    std::atomic<uint64_t> _requests { 0 };
+    std::atomic<uint64_t> _errors { 0 };
+
+    // canned responses
+    string _profile;
+    string _margins;
+    string _segmentMargins;
+    string _orderID;
+    string _orders;
+    string _trades;
+    string _positions;
+    string _holdings;
+    string _converted;
+    string _instruments;
+    string _candles;
+    string _GTTs;
+    string _GTT;
+    string _triggerID;
+
+    // methods
+
+    static string _success(const string& data) { return R"({"status":"success","data":)" + data + "}"; };
+
+    // joins n items made by item(i)
+    template <typename Fn> static string _join(size_t n, Fn item) {
+
+        string out;
+        for (size_t i = 0; i < n; i++) {
+            if (i != 0) { out.push_back(','); };
+            out.append(item(i));
+        };
+        return out;
+    };
+
+    static string _order(size_t i) {
+        return FMT(R"({{"account_id":"AB1234","placed_by":"AB1234","order_id":"2106010000{0:05}",)"
+                   R"("exchange_order_id":"13000000{0:08}","parent_order_id":null,"status":"COMPLETE",)"
+                   R"("status_message":null,"status_message_raw":null,"order_timestamp":"2021-06-01 09:18:57",)"
+                   R"("exchange_update_timestamp":"2021-06-01 09:18:58","exchange_timestamp":"2021-06-01 09:18:58",)"
+                   R"("variety":"regular","exchange":"NSE","tradingsymbol":"SYM{0}","instrument_token":{1},)"
+                   R"("order_type":"LIMIT","transaction_type":"BUY","validity":"DAY","product":"CNC","quantity":1,)"
+                   R"("disclosed_quantity":0,"price":109.4,"trigger_price":0,"average_price":109.4,)"
+                   R"("filled_quantity":1,"pending_quantity":0,"cancelled_quantity":0,"market_protection":0,)"
+                   R"("meta":{{}},"tag":null,"guid":"XXXXXX"}})",
+            i, 400000 + i);
+    };
+
+    static string _trade(size_t i) {
+        return FMT(R"({{"trade_id":"{0}","order_id":"2106010000{0:05}","exchange_order_id":"13000000{0:08}",)"
+                   R"("tradingsymbol":"SYM{0}","exchange":"NSE","instrument_token":{1},"product":"CNC",)"
+                   R"("average_price":109.4,"quantity":1,"fill_timestamp":"2021-06-01 09:18:58",)"
+                   R"("exchange_timestamp":"2021-06-01 09:18:58","transaction_type":"BUY"}})",
+            i, 400000 + i);
+    };
+
+    static string _position(size_t i) {
+        return FMT(R"({{"tradingsymbol":"SYM{0}","exchange":"NSE","instrument_token":{1},"product":"MIS",)"
+                   R"("quantity":1,"overnight_quantity":0,"multiplier":1,"average_price":161.05,"close_price":0,)"
+                   R"("last_price":161.05,"value":-161.05,"pnl":0,"m2m":0,"unrealised":0,"realised":0,)"
+                   R"("buy_quantity":1,"buy_price":161.05,"buy_value":161.05,"buy_m2m":161.05,"sell_quantity":0,)"
+                   R"("sell_price":0,"sell_value":0,"sell_m2m":0,"day_buy_quantity":1,"day_buy_price":161.05,)"
+                   R"("day_buy_value":161.05,"day_sell_quantity":0,"day_sell_price":0,"day_sell_value":0}})",
+            i, 400000 + i);
+    };
+
+    static string _holding(size_t i) {
+        return FMT(R"({{"tradingsymbol":"SYM{0}","exchange":"NSE","instrument_token":{1},"isin":"INE000A0{0:04}",)"
+                   R"("product":"CNC","price":0,"quantity":10,"t1_quantity":0,"realised_quantity":10,)"
+                   R"("collateral_quantity":0,"collateral_type":"","average_price":1412.3,"last_price":1420.5,)"
+                   R"("close_price":1415.2,"pnl":82,"day_change":5.3,"day_change_percentage":0.37}})",
+            i, 400000 + i);
+    };
+
+    static string _GTTEntry(size_t i) {
+        return FMT(R"({{"id":{0},"user_id":"AB1234","type":"single","created_at":"2021-06-01 09:18:57",)"
+                   R"("updated_at":"2021-06-01 09:18:57","expires_at":"2022-06-01 09:18:57","status":"active",)"
+                   R"("condition":{{"exchange":"NSE","tradingsymbol":"SYM{0}","last_price":798,)"
+                   R"("trigger_values":[702]}},"orders":[{{"exchange":"NSE","tradingsymbol":"SYM{0}",)"
+                   R"("product":"CNC","order_type":"LIMIT","transaction_type":"BUY","quantity":1,"price":702.5}}]}})",
+            i + 1);
+    };
+
+    static string _candle(size_t i) {
+        return FMT(R"(["2021-06-01T{0:02}:{1:02}:{2:02}+0530",1704.5,1705,1699.25,1702.8,2499,0])", 9 + (i / 3600) % 14,
+            (i / 60) % 60, i % 60);
+    };
+
+    static string _instrument(size_t i) {
+        return FMT("{0},{1},SYM{2},SYMBOL {2},0,,0,0.05,1,EQ,NSE,NSE\n", 400000 + i, 1500 + i, i);
+    };
+
+    static string _quote(const string& symbol, size_t i) {
+        return FMT(R"("{0}":{{"instrument_token":{1},"timestamp":"2021-06-08 15:45:56",)"
+                   R"("last_trade_time":"2021-06-08 15:45:52","last_price":1412.95,"last_quantity":5,)"
+                   R"("buy_quantity":0,"sell_quantity":5191,"volume":7360198,"average_price":1412.47,"oi":0,)"
+                   R"("oi_day_high":0,"oi_day_low":0,"net_change":0,"lower_circuit_limit":1271.7,)"
+                   R"("upper_circuit_limit":1554.2,"ohlc":{{"open":1396,"high":1421.75,"low":1395.55,)"
+                   R"("close":1389.65}},"depth":{{"buy":[{{"price":1412.9,"quantity":10,"orders":1}},)"
+                   R"({{"price":1412.85,"quantity":4,"orders":2}},{{"price":1412.8,"quantity":3,"orders":1}},)"
+                   R"({{"price":1412.75,"quantity":7,"orders":2}},{{"price":1412.7,"quantity":1,"orders":1}}],)"
+                   R"("sell":[{{"price":1412.95,"quantity":5191,"orders":13}},)"
+                   R"({{"price":1413,"quantity":20,"orders":2}},)"
+                   R"({{"price":1413.05,"quantity":2,"orders":1}},{{"price":1413.1,"quantity":8,"orders":1}},)"
+                   R"({{"price":1413.15,"quantity":9,"orders":3}}]}}}})",
+            symbol, 400000 + i);
+    };
+
+    static string _OHLCQuote(const string& symbol, size_t i) {
+        return FMT(R"("{0}":{{"instrument_token":{1},"last_price":1412.95,)"
+                   R"("ohlc":{{"open":1396,"high":1421.75,"low":1395.55,"close":1389.65}}}})",
+            symbol, 400000 + i);
+    };
+
+    static string _LTPQuote(const string& symbol, size_t i) {
+        return FMT(R"("{0}":{{"instrument_token":{1},"last_price":1412.95}})", symbol, 400000 + i);
+    };
+
+    static string _orderMargins(size_t /*i*/) {
+        return R"({"type":"equity","tradingsymbol":"INFY","exchange":"NSE","span":0,"exposure":0,)"
+               R"("option_premium":0,"additional":0,"bo":0,"cash":0,"var":1498,"pnl":{"realised":0,"unrealised":0},)"
+               R"("total":1498})";
+    };
+
+    void _buildPayloads() {
+
+        const string segment =
+            R"({"enabled":true,"net":99725.05,"available":{"adhoc_margin":0,"cash":245431.6,"collateral":0,)"
+            R"("intraday_payin":0},"utilised":{"debits":145706.55,"exposure":38981.25,"m2m_realised":761.7,)"
+            R"("m2m_unrealised":0,"option_premium":0,"payout":0,"span":101989,"holding_sales":0,"turnover":0}})";
+        const size_t n = _config.records;
+
+        _profile = _success(R"({"user_id":"AB1234","user_name":"AxAx Bxx","user_shortname":"AxAx",)"
+                            R"("email":"xxxyyy@gmail.com","user_type":"individual","broker":"ZERODHA",)"
+                            R"("exchanges":["BSE","NSE","MF"],"products":["CNC","NRML","MIS"],)"
+                            R"("order_types":["MARKET","LIMIT","SL","SL-M"],"avatar_url":""})");
+        _margins = _success(R"({"equity":)" + segment + R"(,"commodity":)" + segment + "}");
+        _segmentMargins = _success(segment);
+        _orderID = _success(R"({"order_id":"151220000000000"})");
+        _orders = _success("[" + _join(n, _order) + "]");
+        _trades = _success("[" + _join(n, _trade) + "]");
+        const string positions = _join(n, _position);
+        _positions = _success(R"({"net":[)" + positions + R"(],"day":[)" + positions + "]}");
+        _holdings = _success("[" + _join(n, _holding) + "]");
+        _converted = _success("true");
+        _instruments = "instrument_token,exchange_token,tradingsymbol,name,last_price,expiry,strike,tick_size,lot_size,"
+                       "instrument_type,segment,exchange\n";
+        for (size_t i = 0; i < n; i++) { _instruments.append(_instrument(i)); };
+        _candles = _success(R"({"candles":[)" + _join(n, _candle) + "]}");
+        _GTTs = _success("[" + _join(n, _GTTEntry) + "]");
+        _GTT = _success(_GTTEntry(0));
+        _triggerID = _success(R"({"trigger_id":123})");
+    };
+
+    // quote responses depend on the symbols requested, so they're built per request
+    template <typename Fn> static string _quotes(const httplib::Request& req, Fn quote) {
+
+        string data = "{";
+        size_t i = 0;
+        const auto symbols = req.params.equal_range("i");
+        for (auto it = symbols.first; it != symbols.second; ++it, ++i) {
+            if (i != 0) { data.push_back(','); };
+            data.append(quote(it->second, i));
+        };
+
+        return _success(data + "}");
+    };
+
+    // wraps a handler with latency and error injection
+    _handler _inject(_handler handler) {
+
+        return [this, handler = std::move(handler)](const httplib::Request& req, httplib::Response& res) {
+
+            _requests.fetch_add(1, std::memory_order_relaxed);
+            thread_local std::mt19937_64 rng(std::random_device {}());
+
+            auto delay = _config.latency;
+            if (_config.jitter.count() > 0) {
+                delay += std::chrono::microseconds(
+                    std::uniform_int_distribution<int64_t>(0, _config.jitter.count())(rng));
+            };
+            if (delay.count() > 0) { std::this_thread::sleep_for(delay); };
+
+            if (_config.errorRate > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < _config.errorRate) {
+
+                _errors.fetch_add(1, std::memory_order_relaxed);
+                res.status = 500;
+                res.set_content(R"({"status":"error","message":"Injected error","error_type":"GeneralException"})",
+                    "application/json");
+                return;
+            };
+
+            handler(req, res);
+        };
+    };
+
+    // a handler that always responds with body. body must outlive the server
+    static _handler _canned(const string& body, const char* contentType = "application/json") {
+        return [&body, contentType](const httplib::Request&, httplib::Response& res) {
+            res.set_content(body, contentType);
+        };
+    };
+
+    void _route() {
+
+        httplib::Server& svr = *_server;
+
+        // user
+        svr.Get("/user/profile", _inject(_canned(_profile)));
+        svr.Get("/user/margins", _inject(_canned(_margins)));
+        svr.Get(R"(/user/margins/(\w+))", _inject(_canned(_segmentMargins)));
+
+        // orders
+        svr.Get("/orders", _inject(_canned(_orders)));
+        svr.Post(R"(/orders/(\w+))", _inject(_canned(_orderID)));
+        svr.Put(R"(/orders/(\w+)/(\w+))", _inject(_canned(_orderID)));
+        svr.Delete(R"(/orders/(\w+)/(\w+))", _inject(_canned(_orderID)));
+        svr.Get(R"(/orders/(\w+))", _inject(_canned(_orders)));
+        svr.Get(R"(/orders/(\w+)/trades)", _inject(_canned(_trades)));
+        svr.Get("/trades", _inject(_canned(_trades)));
+
+        // portfolio
+        svr.Get("/portfolio/positions", _inject(_canned(_positions)));
+        svr.Put("/portfolio/positions", _inject(_canned(_converted)));
+        svr.Get("/portfolio/holdings", _inject(_canned(_holdings)));
+
+        // market
+        svr.Get("/instruments", _inject(_canned(_instruments, "text/csv")));
+        svr.Get(R"(/instruments/(\w+))", _inject(_canned(_instruments, "text/csv")));
+        svr.Get(R"(/instruments/historical/(\d+)/(\w+))", _inject(_canned(_candles)));
+        svr.Get("/quote", _inject([](const httplib::Request& req, httplib::Response& res) {
+            res.set_content(_quotes(req, _quote), "application/json");
+        }));
+        svr.Get("/quote/ohlc", _inject([](const httplib::Request& req, httplib::Response& res) {
+            res.set_content(_quotes(req, _OHLCQuote), "application/json");
+        }));
+        svr.Get("/quote/ltp", _inject([](const httplib::Request& req, httplib::Response& res) {
+            res.set_content(_quotes(req, _LTPQuote), "application/json");
+        }));
+
+        // GTT
+        svr.Get("/gtt/triggers", _inject(_canned(_GTTs)));
+        svr.Post("/gtt/triggers", _inject(_canned(_triggerID)));
+        svr.Get(R"(/gtt/triggers/(\d+))", _inject(_canned(_GTT)));
+        svr.Put(R"(/gtt/triggers/(\d+))", _inject(_canned(_triggerID)));
+        svr.Delete(R"(/gtt/triggers/(\d+))", _inject(_canned(_triggerID)));
+
+        // margins. One entry per order in the request
+        svr.Post("/margins/orders", _inject([](const httplib::Request& req, httplib::Response& res) {
+            size_t orders = 0;
+            for (size_t pos = req.body.find("\"exchange\""); pos != string::npos;
+                 pos = req.body.find("\"exchange\"", pos + 1)) {
+                orders++;
+            };
+            res.set_content(_success("[" + _join(orders, _orderMargins) + "]"), "application/json");
+        }));
+    };
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,158 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// compares parsing responses through a DOM (rj::Document + struct::parse()) with the SAX parser
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kitepp/responses.hpp"
+#include "kitepp/saxparser.hpp"
+
+namespace kc = kiteconnect;
+namespace rj = rapidjson;
+using std::string;
+
+namespace {
+
+const char* const orderJSON =
+    R"({"account_id":"AB1234","placed_by":"AB1234","order_id":"210531000000{0}","exchange_order_id":"1300000001887410",)"
+    R"("parent_order_id":null,"status":"COMPLETE","status_message":null,"status_message_raw":null,)"
+    R"("order_timestamp":"2021-05-31 09:18:57","exchange_update_timestamp":"2021-05-31 09:18:58",)"
+    R"("exchange_timestamp":"2021-05-31 09:18:58","variety":"regular","exchange":"NSE","tradingsymbol":"IOC",)"
+    R"("instrument_token":415745,"order_type":"LIMIT","transaction_type":"BUY","validity":"DAY","product":"CNC",)"
+    R"("quantity":1,"disclosed_quantity":0,"price":109.4,"trigger_price":0,"average_price":109.4,)"
+    R"("filled_quantity":1,"pending_quantity":0,"cancelled_quantity":0,"market_protection":0,"meta":{},)"
+    R"("tag":null,"guid":"XXXXXX"})";
+
+const char* const positionJSON =
+    R"({"tradingsymbol":"LEADMINI17DECFUT","exchange":"MCX","instrument_token":{0},"product":"NRML","quantity":1,)"
+    R"("overnight_quantity":0,"multiplier":1000,"average_price":161.05,"close_price":0,"last_price":161.05,)"
+    R"("value":-161050,"pnl":0,"m2m":0,"unrealised":0,"realised":0,"buy_quantity":1,"buy_price":161.05,)"
+    R"("buy_value":161050,"buy_m2m":161050,"sell_quantity":0,"sell_price":0,"sell_value":0,"sell_m2m":0,)"
+    R"("day_buy_quantity":1,"day_buy_price":161.05,"day_buy_value":161050,"day_sell_quantity":0,)"
+    R"("day_sell_price":0,"day_sell_value":0})";
+
+const char* const quoteJSON =
+    R"("NSE:SYM{0}":{"instrument_token":{0},"timestamp":"2021-06-08 15:45:56","last_trade_time":"2021-06-08 15:45:52",)"
+    R"("last_price":1412.95,"last_quantity":5,"buy_quantity":0,"sell_quantity":5191,"volume":7360198,)"
+    R"("average_price":1412.47,"oi":0,"oi_day_high":0,"oi_day_low":0,"net_change":0,"lower_circuit_limit":1271.7,)"
+    R"("upper_circuit_limit":1554.2,"ohlc":{"open":1396,"high":1421.75,"low":1395.55,"close":1389.65},)"
+    R"("depth":{"buy":[{"price":1412.9,"quantity":10,"orders":1},{"price":1412.85,"quantity":4,"orders":2},)"
+    R"({"price":1412.8,"quantity":3,"orders":1},{"price":1412.75,"quantity":7,"orders":2},)"
+    R"({"price":1412.7,"quantity":1,"orders":1}],"sell":[{"price":1412.95,"quantity":5191,"orders":13},)"
+    R"({"price":1413,"quantity":20,"orders":2},{"price":1413.05,"quantity":2,"orders":1},)"
+    R"({"price":1413.1,"quantity":8,"orders":1},{"price":1413.15,"quantity":9,"orders":3}]}})";
+
+// joins n copies of item, with `{0}` in them replaced by 1..n
+string repeat(const char* item, size_t n) {
+
+    const string tmpl = item;
+    string out;
+    for (size_t i = 0; i < n; i++) {
+
+        if (i != 0) { out.push_back(','); };
+        const string id = std::to_string(i + 1);
+        size_t start = 0;
+        for (size_t pos = tmpl.find("{0}"); pos != string::npos; pos = tmpl.find("{0}", start)) {
+            out.append(tmpl, start, pos - start).append(id);
+            start = pos + 3;
+        };
+        out.append(tmpl, start, string::npos);
+    };
+
+    return out;
+};
+
+template <typename Fn> double timeIt(size_t iterations, Fn fn) {
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) { fn(); };
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::micro>(elapsed).count() / static_cast<double>(iterations);
+};
+
+void report(const char* name, size_t records, double domUs, double saxUs) {
+    std::printf("%-10s %6zu records   DOM %10.1f us   SAX %10.1f us   %.2fx\n", name, records, domUs, saxUs,
+        domUs / saxUs);
+};
+
+} // namespace
+
+int main(int argc, char const* argv[]) {
+
+    const size_t records = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    const size_t iterations = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+    // orders
+    {
+        const string json = R"({"status":"success","data":[)" + repeat(orderJSON, records) + "]}";
+        const double dom = timeIt(iterations, [&json]() {
+            rj::Document res;
+            res.Parse(json.c_str());
+            std::vector<kc::order> orders;
+            for (auto& i : res["data"].GetArray()) { orders.emplace_back(i.GetObject()); };
+        });
+        const double sax = timeIt(iterations, [&json]() {
+            string body = json;
+            std::vector<kc::order> orders;
+            kc::_saxParse(body, orders);
+        });
+        report("orders", records, dom, sax);
+    };
+
+    // positions
+    {
+        const string positions = repeat(positionJSON, records);
+        const string json = R"({"status":"success","data":{"net":[)" + positions + R"(],"day":[)" + positions + "]}}";
+        const double dom = timeIt(iterations, [&json]() {
+            rj::Document res;
+            res.Parse(json.c_str());
+            kc::positions pos(res["data"].GetObject());
+        });
+        const double sax = timeIt(iterations, [&json]() {
+            string body = json;
+            kc::positions pos;
+            kc::_saxParse(body, pos);
+        });
+        report("positions", records * 2, dom, sax);
+    };
+
+    // quotes
+    {
+        const string json = R"({"status":"success","data":{)" + repeat(quoteJSON, records) + "}}";
+        const double dom = timeIt(iterations, [&json]() {
+            rj::Document res;
+            res.Parse(json.c_str());
+            std::unordered_map<string, kc::quote> quotes;
+            for (auto& i : res["data"].GetObject()) { quotes.emplace(i.name.GetString(), i.value.GetObject()); };
+        });
+        const double sax = timeIt(iterations, [&json]() {
+            string body = json;
+            std::unordered_map<string, kc::quote> quotes;
+            kc::_saxParse(body, quotes);
+        });
+        report("quotes", records, dom, sax);
+    };
+
+    return 0;
+};
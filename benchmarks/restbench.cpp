@@ -0,0 +1,194 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// drives kite against a local mockKite from many threads and reports requests/sec, latency percentiles and heap
+// allocations per call for the main REST calls.
+//
+// usage: restbench [threads] [calls per thread] [latency us] [error rate] [records] [cert.pem key.pem]
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "kitepp/kite.hpp"
+#include "kitepp/metrics.hpp"
+#include "mockkite.hpp"
+
+namespace kc = kiteconnect;
+using std::string;
+
+namespace {
+
+// allocations made by the calling thread. Counted per thread so that the server's allocations are left out
+thread_local uint64_t allocations = 0;
+
+struct scenario {
+
+    const char* name;
+    std::function<void(kc::kite&)> call;
+};
+
+struct result {
+
+    kc::latencyHistogram latencies;
+    std::atomic<uint64_t> allocations { 0 };
+    std::atomic<uint64_t> errors { 0 };
+    double seconds = 0.0;
+};
+
+void run(const scenario& scn, const string& URL, size_t threads, size_t calls, result& res) {
+
+    std::vector<std::thread> workers;
+    std::atomic<size_t> ready { 0 };
+    std::atomic<bool> go { false };
+
+    for (size_t t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            // a kite per thread, so that threads don't wait on each other's connection
+            kc::kite Kite("api_key");
+            Kite.setAccessToken("access_token");
+            auto trans = std::make_unique<kc::httpTransport>(URL);
+            trans->getClient().enable_server_certificate_verification(false); // mockKite's certificate is self-signed
+            Kite.setTransport(std::move(trans));
+            Kite.warmup();
+
+            ready++;
+            while (!go) { std::this_thread::yield(); };
+
+            uint64_t allocs = 0;
+            for (size_t i = 0; i < calls; i++) {
+
+                const int64_t start = kc::_steadyNs();
+                const uint64_t allocsBefore = allocations;
+                try {
+                    scn.call(Kite);
+                } catch (const std::exception&) { res.errors++; };
+                allocs += allocations - allocsBefore;
+                res.latencies.record(kc::_steadyNs() - start);
+            };
+            res.allocations += allocs;
+        });
+    };
+
+    while (ready != threads) { std::this_thread::yield(); };
+    const auto start = std::chrono::steady_clock::now();
+    go = true;
+    for (auto& worker : workers) { worker.join(); };
+    res.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+};
+
+void report(const char* name, const result& res) {
+
+    const double calls = static_cast<double>(res.latencies.getCount());
+    std::printf("%-14s %10.0f %10.1f %10.1f %10.1f %10.1f %12.1f %8llu\n", name, calls / res.seconds,
+        res.latencies.getPercentile(50) / 1000.0, res.latencies.getPercentile(90) / 1000.0,
+        res.latencies.getPercentile(99) / 1000.0, res.latencies.getMax() / 1000.0,
+        static_cast<double>(res.allocations) / calls, static_cast<unsigned long long>(res.errors.load()));
+};
+
+} // namespace
+
+// counts allocations. GCC can't tell these free() what operator new returned
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size) {
+
+    allocations++;
+    if (void* ptr = std::malloc((size != 0) ? size : 1)) { return ptr; };
+    throw std::bad_alloc();
+};
+
+void operator delete(void* ptr) noexcept { std::free(ptr); };
+
+void operator delete(void* ptr, size_t /*size*/) noexcept { std::free(ptr); };
+
+int main(int argc, char const* argv[]) {
+
+    const size_t threads = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 8;
+    const size_t calls = (argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 2000;
+
+    kc::mockKiteConfig config;
+    config.latency = std::chrono::microseconds((argc > 3) ? std::strtol(argv[3], nullptr, 10) : 0);
+    config.errorRate = (argc > 4) ? std::strtod(argv[4], nullptr) : 0.0;
+    config.records = (argc > 5) ? std::strtoul(argv[5], nullptr, 10) : 50;
+    config.threads = threads + 2;
+    if (argc > 7) {
+        config.certPath = argv[6];
+        config.keyPath = argv[7];
+    };
+
+    kc::mockKite mock(config);
+    mock.start();
+    const string URL = mock.getURL();
+
+    const kc::preparedOrder prepared("regular", "NSE", "INFY", "BUY", "CNC", "LIMIT", 0.05);
+    const std::vector<string> symbols = { "NSE:INFY", "NSE:TCS", "NSE:SBIN", "NSE:ITC", "NSE:RELIANCE", "NSE:HDFC",
+        "NSE:WIPRO", "NSE:LT", "NSE:ONGC", "NSE:NTPC" };
+    std::vector<kc::orderMarginsParams> margins(1);
+    margins[0].exchange = "NSE";
+    margins[0].tradingsymbol = "INFY";
+    margins[0].transactionType = "BUY";
+    margins[0].variety = "regular";
+    margins[0].product = "CNC";
+    margins[0].orderType = "MARKET";
+    margins[0].quantity = 1;
+
+    // clang-format off
+    const std::vector<scenario> scenarios = {
+        { "placeOrder", [](kc::kite& k) { k.placeOrder("regular", "NSE", "INFY", "BUY", 1, "CNC", "LIMIT", 1412.5); } },
+        { "placeOrder(p)", [&prepared](kc::kite& k) { k.placeOrder(prepared, 1, 1412.55); } },
+        { "modifyOrder", [&prepared](kc::kite& k) { k.modifyOrder(prepared, "151220000000000", 1, 1412.6); } },
+        { "cancelOrder", [](kc::kite& k) { k.cancelOrder("regular", "151220000000000"); } },
+        { "orders", [](kc::kite& k) { k.orders(); } },
+        { "ordersCompact", [](kc::kite& k) { k.ordersCompact(); } },
+        { "trades", [](kc::kite& k) { k.trades(); } },
+        { "positions", [](kc::kite& k) { k.getPositions(); } },
+        { "holdings", [](kc::kite& k) { k.holdings(); } },
+        { "quote", [&symbols](kc::kite& k) { k.getQuote(symbols); } },
+        { "LTP", [&symbols](kc::kite& k) { k.getLTP(symbols); } },
+        { "historical", [](kc::kite& k) {
+            k.getHistoricalCandles(408065, "2021-06-01 09:15:00", "2021-06-01 15:30:00", "minute"); } },
+        { "instruments", [](kc::kite& k) { k.getInstruments("NSE"); } },
+        { "GTTs", [](kc::kite& k) { k.getGTTs(); } },
+        { "orderMargins", [&margins](kc::kite& k) { k.getOrderMargins(margins); } },
+        { "margins", [](kc::kite& k) { k.getMargins(); } },
+    };
+    // clang-format on
+
+    std::printf("%zu threads, %zu calls per thread, %lld us latency, %.3f error rate, %zu records, %s\n\n", threads,
+        calls, static_cast<long long>(config.latency.count()), config.errorRate, config.records, URL.c_str());
+    std::printf("%-14s %10s %10s %10s %10s %10s %12s %8s\n", "call", "req/s", "p50 us", "p90 us", "p99 us", "max us",
+        "allocs/call", "errors");
+
+    for (const auto& scn : scenarios) {
+
+        result res;
+        run(scn, URL, threads, calls, res);
+        report(scn.name, res);
+    };
+
+    mock.stop();
+    return 0;
+};
@@ -25,6 +25,18 @@
 
 #define CPPHTTPLIB_OPENSSL_SUPPORT
 
+#include "kitepp/asyncclient.hpp"
+#include "kitepp/candlestore.hpp"
+#include "kitepp/historicaldownloader.hpp"
+#include "kitepp/instrumentcache.hpp"
+#include "kitepp/instrumentstore.hpp"
 #include "kitepp/kite.hpp"
 #include "kitepp/kitews.hpp"
-#include "kitepp/userconstants.hpp"
\ No newline at end of file
+#include "kitepp/modifycoalescer.hpp"
+#include "kitepp/optionchain.hpp"
+#include "kitepp/orderstore.hpp"
+#include "kitepp/positionengine.hpp"
+#include "kitepp/quotebatcher.hpp"
+#include "kitepp/quotecache.hpp"
+#include "kitepp/userconstants.hpp"
+#include "kitepp/uwseventloop.hpp"
\ No newline at end of file
@@ -0,0 +1,908 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has a non-blocking REST client that runs on an event loop, e.g. the one `kiteWS` runs on (see
+// uwseventloop.hpp)
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <openssl/err.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include "config.hpp"
+#include "kite.hpp"
+#include "kiteppexceptions.hpp"
+#include "metrics.hpp"
+#include "preparedorder.hpp"
+#include "requestbuilder.hpp"
+#include "rjutils.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/**
+ * @brief Event loop that watches the sockets of `asyncClient`. Callbacks must be called on the loop's thread
+ *
+ */
+class eventLoop {
+
+  public:
+    // member variables
+
+    static constexpr int READABLE = 1;
+    static constexpr int WRITABLE = 2;
+    static constexpr int FAILED = 4; // passed to callbacks when polling the socket failed
+
+    // constructors and destructor
+
+    virtual ~eventLoop() = default;
+
+    // methods
+
+    /**
+     * @brief start watching a socket
+     *
+     * @param fd socket
+     * @param events events to watch
+     * @param cb called with the events that occurred
+     */
+    virtual void watch(int fd, int events, std::function<void(int events)> cb) = 0;
+
+    /**
+     * @brief change events a watched socket is watched for
+     *
+     * @param fd socket
+     * @param events
+     */
+    virtual void change(int fd, int events) = 0;
+
+    /**
+     * @brief stop watching a socket. May be called from the socket's callback
+     *
+     * @param fd socket
+     */
+    virtual void unwatch(int fd) = 0;
+};
+
+// incremental parser of HTTP/1.1 responses
+class _responseParser {
+
+  public:
+    // member variables
+
+    int code = 0;
+    string body;
+    bool keepAlive = true;
+
+    // methods
+
+    void reset() {
+
+        code = 0;
+        body.clear();
+        keepAlive = true;
+        _buf.clear();
+        _pos = 0;
+        _headersDone = false;
+        _chunked = false;
+        _contentLength = -1;
+        _chunkLeft = _NOCHUNK;
+    };
+
+    // returns true once the response is complete. Throws libException if the response is malformed
+    bool feed(const char* data, size_t size) {
+
+        _buf.append(data, size);
+
+        if (!_headersDone) {
+
+            const size_t end = _buf.find("\r\n\r\n");
+            if (end == string::npos) { return false; };
+            _parseHead(std::string_view(_buf.data(), end));
+            _pos = end + 4;
+            _headersDone = true;
+        };
+
+        if (_chunked) { return _dechunk(); };
+        if (_contentLength >= 0) {
+
+            if (_buf.size() - _pos < static_cast<size_t>(_contentLength)) { return false; };
+            body.assign(_buf, _pos, static_cast<size_t>(_contentLength));
+            return true;
+        };
+
+        return false;
+    };
+
+    // returns true if the connection closing completes the response, i.e. its body is delimited by the close
+    bool finish() {
+
+        if (!_headersDone || _chunked || _contentLength >= 0) { return false; };
+        body.assign(_buf, _pos, string::npos);
+        keepAlive = false;
+        return true;
+    };
+
+  private:
+    // member variables
+
+    static constexpr size_t _NOCHUNK = static_cast<size_t>(-1);
+
+    string _buf;
+    size_t _pos = 0;
+    bool _headersDone = false;
+    bool _chunked = false;
+    long _contentLength = -1;
+    size_t _chunkLeft = _NOCHUNK; // bytes left in the current chunk. _NOCHUNK if its size line is expected next
+
+    // methods
+
+    static bool _equals(std::string_view lhs, std::string_view rhs) {
+
+        if (lhs.size() != rhs.size()) { return false; };
+        for (size_t i = 0; i < lhs.size(); i++) {
+            if (std::tolower(static_cast<unsigned char>(lhs[i])) != rhs[i]) { return false; };
+        };
+        return true;
+    };
+
+    static std::string_view _trim(std::string_view str) {
+
+        while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) { str.remove_prefix(1); };
+        while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) { str.remove_suffix(1); };
+        return str;
+    };
+
+    void _parseHead(std::string_view head) {
+
+        size_t eol = head.find("\r\n");
+        const std::string_view status = head.substr(0, eol);
+        if (status.size() < 12 || status.compare(0, 5, "HTTP/") != 0) {
+            throw libException("Malformed status line was received (asyncClient)");
+        };
+        code = std::atoi(string(status.substr(9, 3)).c_str());
+        keepAlive = status.compare(0, 8, "HTTP/1.0") != 0;
+
+        while (eol != std::string_view::npos) {
+
+            const size_t start = eol + 2;
+            eol = head.find("\r\n", start);
+            const std::string_view line = head.substr(start, (eol == std::string_view::npos) ? eol : eol - start);
+            const size_t colon = line.find(':');
+            if (colon == std::string_view::npos) { continue; };
+
+            const std::string_view name = line.substr(0, colon);
+            const std::string_view value = _trim(line.substr(colon + 1));
+            if (_equals(name, "content-length")) {
+                _contentLength = std::atol(string(value).c_str());
+            } else if (_equals(name, "transfer-encoding")) {
+                _chunked = value.find("chunked") != std::string_view::npos;
+            } else if (_equals(name, "connection")) {
+                if (_equals(value, "close")) { keepAlive = false; };
+                if (_equals(value, "keep-alive")) { keepAlive = true; };
+            };
+        };
+
+        if (code == 204 || code == 304) { _contentLength = 0; };
+    };
+
+    bool _dechunk() {
+
+        while (true) {
+
+            if (_chunkLeft == _NOCHUNK) {
+
+                const size_t eol = _buf.find("\r\n", _pos);
+                if (eol == string::npos) { return false; };
+                char* end = nullptr;
+                const size_t size = std::strtoul(_buf.c_str() + _pos, &end, 16);
+                if (end == _buf.c_str() + _pos) { throw libException("Malformed chunk was received (asyncClient)"); };
+
+                if (size == 0) {
+                    // the last chunk is followed by optional trailers and an empty line
+                    return _buf.compare(eol + 2, 2, "\r\n") == 0 || _buf.find("\r\n\r\n", eol) != string::npos;
+                };
+                _pos = eol + 2;
+                _chunkLeft = size;
+            };
+
+            if (_buf.size() - _pos < _chunkLeft + 2) { return false; };
+            body.append(_buf, _pos, _chunkLeft);
+            _pos += _chunkLeft + 2;
+            _chunkLeft = _NOCHUNK;
+        };
+    };
+};
+
+/**
+ * @brief Non-blocking REST client that runs on an event loop.
+ *
+ * Requests are sent over a small pool of keep-alive TLS connections whose sockets are watched by the loop, so sending a
+ * request from e.g. a tick callback doesn't block the loop. Requests wait in a queue until a connection is free and
+ * are sent in the order they were made. Callbacks are called on the loop once the response is received; errors
+ * (including API errors) are passed to them as exceptions.
+ *
+ * Requests are built and responses are parsed the same way `kite` does and its API key and access token are used.
+ * Everything, including the constructor, must be called on the loop's thread. Requests that are pending when the
+ * client is destroyed are dropped without calling their callbacks.
+ *
+ * Requests aren't retried on errors since orders can't be safely placed twice. Requests that haven't been answered
+ * within the timeout (see `setTimeout()`) fail, and the connection they were sent on is closed.
+ */
+class asyncClient {
+
+  public:
+    /// called with the body of a successful response or an exception
+    using responseCallback = std::function<void(string& body, std::exception_ptr error)>;
+    /// called with the order ID or an exception
+    using orderCallback = std::function<void(const string& orderID, std::exception_ptr error)>;
+
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new asyncClient object. The host is resolved here, which blocks
+     *
+     * @param Kite kite object whose API key and access token are used. Must outlive the client
+     * @param loop event loop. Must outlive the client
+     * @param connections number of connections
+     * @param host host requests are sent to
+     * @param port
+     */
+    asyncClient(kite& Kite, eventLoop& loop, size_t connections = 2, const string& host = "api.kite.trade",
+        int port = 443)
+        : _kite(Kite), _loop(loop), _host(host), _connections(connections ? connections : 1) {
+
+        addrinfo hints {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        const int err = getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &result);
+        if (err != 0 || result == nullptr) {
+            throw libException(FMT("Failed to resolve {0} ({1}) (asyncClient)", host, gai_strerror(err)));
+        };
+        std::memcpy(&_addr, result->ai_addr, result->ai_addrlen);
+        _addrLen = result->ai_addrlen;
+        _family = result->ai_family;
+        freeaddrinfo(result);
+
+        _ctx = SSL_CTX_new(TLS_client_method());
+        if (_ctx == nullptr) { throw libException("Failed to create SSL context (asyncClient)"); };
+        SSL_CTX_set_min_proto_version(_ctx, TLS1_2_VERSION);
+        SSL_CTX_set_default_verify_paths(_ctx);
+        SSL_CTX_set_verify(_ctx, SSL_VERIFY_PEER, nullptr);
+        // lets reconnects resume the TLS session instead of doing a full handshake
+        SSL_CTX_set_session_cache_mode(_ctx, SSL_SESS_CACHE_CLIENT);
+
+        // deadlines of requests are enforced by a timer that's watched like the sockets
+        _timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (_timerFd < 0) {
+            SSL_CTX_free(_ctx);
+            throw libException(FMT("Failed to create timer ({0}) (asyncClient)", std::strerror(errno)));
+        };
+        _loop.watch(_timerFd, eventLoop::READABLE, [this](int /*events*/) { _onTimer(); });
+    };
+
+    asyncClient(const asyncClient&) = delete;
+    asyncClient& operator=(const asyncClient&) = delete;
+
+    ~asyncClient() {
+
+        for (auto& conn : _connections) { _close(conn); };
+        _loop.unwatch(_timerFd);
+        ::close(_timerFd);
+        if (_session != nullptr) { SSL_SESSION_free(_session); };
+        SSL_CTX_free(_ctx);
+    };
+
+    // methods
+
+    /**
+     * @brief Set the file the CA certificates used for verifying the server are loaded from. System's certificates are
+     * used by default
+     *
+     * @param path
+     */
+    void setCACertPath(const string& path) {
+
+        if (SSL_CTX_load_verify_locations(_ctx, path.c_str(), nullptr) != 1) {
+            throw libException(FMT("Failed to load CA certificates from {0} (asyncClient)", path));
+        };
+    };
+
+    /**
+     * @brief Set the time requests sent after this call have for getting a response, including the time spent waiting
+     * in the queue and opening a connection. 5 seconds by default
+     *
+     * @param timeout
+     */
+    void setTimeout(std::chrono::milliseconds timeout) { _timeout = timeout; };
+
+    /**
+     * @brief open all connections ahead of the first request so that it doesn't wait for the handshakes
+     *
+     */
+    void connect() {
+        for (auto& conn : _connections) {
+            if (conn.state == _states::CLOSED) { _open(conn); };
+        };
+    };
+
+    /**
+     * @brief get number of requests that are queued or in flight
+     *
+     * @return size_t
+     */
+    size_t getPendingCount() const {
+
+        size_t count = _queue.size();
+        for (const auto& conn : _connections) { count += (conn.state == _states::BUSY) ? 1 : 0; };
+        return count;
+    };
+
+    /**
+     * @brief get numbers of TLS handshakes done so far
+     *
+     * @return handshakeCounts
+     */
+    handshakeCounts getHandshakeCounts() const { return _counts; };
+
+    /**
+     * @brief place an order from a prepared order. See `kite::placeOrder(const preparedOrder&, ...)`
+     *
+     * @param ord prepared order
+     * @param quantity
+     * @param price pass DEFAULTDOUBLE if not needed
+     * @param trigPrice trigger price. Pass DEFAULTDOUBLE if not needed
+     * @param cb called with the order ID
+     */
+    void placeOrder(const preparedOrder& ord, int quantity, double price, double trigPrice, orderCallback cb) {
+
+        auto& req =
+            _requestBuilder::local().begin(_methods::POST, ord._placePath, "order.place").encoded(ord._placeParams);
+        ord._appendVariable(req, quantity, price, trigPrice);
+        send(req, _orderIDOf(std::move(cb), "placeOrder"));
+    };
+
+    /**
+     * @brief modify an order placed with a prepared order. See `kite::modifyOrder(const preparedOrder&, ...)`
+     *
+     * @param ord prepared order
+     * @param ordID order ID
+     * @param quantity
+     * @param price pass DEFAULTDOUBLE if not needed
+     * @param trigPrice trigger price. Pass DEFAULTDOUBLE if not needed
+     * @param cb called with the order ID
+     */
+    void modifyOrder(const preparedOrder& ord, const string& ordID, int quantity, double price, double trigPrice,
+        orderCallback cb) {
+
+        auto& req = _requestBuilder::local()
+                        .begin<_path::ORDER_MODIFY>(_methods::PUT, ord._variety, ordID)
+                        .encoded(ord._modifyParams);
+        ord._appendVariable(req, quantity, price, trigPrice);
+        send(req, _orderIDOf(std::move(cb), "modifyOrder"));
+    };
+
+    /**
+     * @brief cancel an order. See `kite::cancelOrder()`
+     *
+     * @param variety
+     * @param ordID order ID
+     * @param parentOrdID parent order ID. Only needed for bracket orders
+     * @param cb called with the order ID
+     */
+    void cancelOrder(const string& variety, const string& ordID, const string& parentOrdID, orderCallback cb) {
+
+        auto& req = (variety == "bo") ?
+                        _requestBuilder::local().begin<_path::ORDER_CANCEL_BO>(
+                            _methods::DEL, variety, ordID, parentOrdID) :
+                        _requestBuilder::local().begin<_path::ORDER_CANCEL>(_methods::DEL, variety, ordID);
+        send(req, _orderIDOf(std::move(cb), "cancelOrder"));
+    };
+
+    /**
+     * @brief send a request
+     *
+     * @param req request
+     * @param cb called with the body of the response
+     */
+    void send(const _requestBuilder& req, responseCallback cb) {
+
+        _request& job = _queue.emplace_back();
+        job.cb = std::move(cb);
+        job.deadline = _steadyNs() + std::chrono::duration_cast<std::chrono::nanoseconds>(_timeout).count();
+        _serialize(req, job.bytes);
+        if (_timerAt == 0 || job.deadline < _timerAt) { _armTimer(job.deadline); };
+
+        _dispatch();
+    };
+
+  private:
+    enum class _states
+    {
+        CLOSED,
+        CONNECTING,
+        HANDSHAKING,
+        READY,
+        BUSY
+    };
+
+    struct _request {
+
+        string bytes;
+        responseCallback cb;
+        int64_t deadline = 0; // steady clock, in nanoseconds
+    };
+
+    struct _connection {
+
+        _states state = _states::CLOSED;
+        int fd = -1;
+        SSL* ssl = nullptr;
+        int events = 0;
+        string out; // encrypted bytes that couldn't be sent yet
+        size_t outPos = 0;
+        _request job;
+        _responseParser parser;
+    };
+
+    // member variables
+
+    kite& _kite;
+    eventLoop& _loop;
+    string _host;
+    sockaddr_storage _addr {};
+    socklen_t _addrLen = 0;
+    int _family = AF_INET;
+    SSL_CTX* _ctx = nullptr;
+    SSL_SESSION* _session = nullptr;
+    handshakeCounts _counts;
+    std::vector<_connection> _connections; // never resized, so connections captured by callbacks stay valid
+    std::deque<_request> _queue;
+    std::chrono::milliseconds _timeout { 5000 };
+    int _timerFd = -1;
+    int64_t _timerAt = 0; // deadline the timer is armed for. 0 if it isn't
+
+    // methods
+
+    void _serialize(const _requestBuilder& req, string& bytes) const {
+
+        static constexpr const char* methods[] = { "GET", "POST", "PUT", "DELETE", "HEAD" };
+
+        const string& body = req.body();
+        bytes.reserve(256 + req.path().size() + body.size());
+        bytes.append(methods[static_cast<size_t>(req.method())]).append(" ").append(req.path());
+        bytes.append(" HTTP/1.1\r\nHost: ").append(_host).append("\r\n");
+        for (const auto& header : _kite._headers) {
+            bytes.append(header.first).append(": ").append(header.second).append("\r\n");
+        };
+        if (req.method() == _methods::POST || req.method() == _methods::PUT) {
+            bytes.append("Content-Type: application/x-www-form-urlencoded\r\nContent-Length: ");
+            bytes.append(std::to_string(body.size())).append("\r\n");
+        };
+        bytes.append("\r\n").append(body);
+    };
+
+    // hands queued requests to free connections and opens connections for the rest
+    void _dispatch() {
+
+        size_t opening = 0;
+        for (auto& conn : _connections) {
+
+            if (conn.state == _states::READY && !_queue.empty()) { _start(conn); };
+            if (conn.state == _states::CONNECTING || conn.state == _states::HANDSHAKING) { opening++; };
+        };
+        for (auto& conn : _connections) {
+
+            if (opening >= _queue.size()) { break; };
+            if (conn.state == _states::CLOSED) {
+                opening++;
+                _open(conn);
+            };
+        };
+    };
+
+    void _open(_connection& conn) {
+
+        conn.fd = socket(_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (conn.fd < 0) { return _fail(conn, FMT("Failed to create socket ({0})", std::strerror(errno))); };
+        int one = 1;
+        setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        if (::connect(conn.fd, reinterpret_cast<const sockaddr*>(&_addr), _addrLen) != 0 && errno != EINPROGRESS) {
+            return _fail(conn, FMT("Failed to connect ({0})", std::strerror(errno)));
+        };
+
+        conn.state = _states::CONNECTING;
+        conn.events = eventLoop::WRITABLE;
+        _loop.watch(conn.fd, conn.events, [this, &conn](int events) { _onEvents(conn, events); });
+    };
+
+    void _close(_connection& conn) {
+
+        if (conn.fd >= 0) {
+            if (conn.state != _states::CLOSED) { _loop.unwatch(conn.fd); };
+            ::close(conn.fd);
+        };
+        if (conn.ssl != nullptr) { SSL_free(conn.ssl); };
+        conn.fd = -1;
+        conn.ssl = nullptr;
+        conn.events = 0;
+        conn.out.clear();
+        conn.outPos = 0;
+        conn.state = _states::CLOSED;
+    };
+
+    // closes the connection and passes the error to its request. If it failed before it could be used, queued
+    // requests fail too, since they'd likely fail the same way
+    void _fail(_connection& conn, const string& msg) {
+
+        const bool established = conn.state == _states::READY || conn.state == _states::BUSY;
+        const bool busy = conn.state == _states::BUSY;
+        _close(conn);
+
+        std::exception_ptr error = std::make_exception_ptr(libException(FMT("{0} (asyncClient)", msg)));
+        std::vector<responseCallback> failed;
+        if (busy) { failed.push_back(std::move(conn.job.cb)); };
+        if (!established) {
+            for (auto& job : _queue) { failed.push_back(std::move(job.cb)); };
+            _queue.clear();
+        };
+
+        string empty;
+        for (auto& cb : failed) {
+            if (cb) { cb(empty, error); };
+        };
+
+        // queued requests are sent over the other connections or a new one
+        if (established) { _dispatch(); };
+    };
+
+    void _onEvents(_connection& conn, int events) {
+
+        if (conn.state == _states::CONNECTING) {
+
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &err, &len);
+            if (err != 0 || (events & eventLoop::FAILED) != 0) {
+                return _fail(conn, FMT("Failed to connect ({0})", std::strerror(err)));
+            };
+            if ((events & eventLoop::WRITABLE) == 0) { return; };
+
+            _startTLS(conn);
+            return;
+        };
+
+        if ((events & eventLoop::FAILED) != 0) { return _fail(conn, "Polling the socket failed"); };
+        if ((events & eventLoop::WRITABLE) != 0 && !_flush(conn)) { return; };
+        if ((events & eventLoop::READABLE) != 0) { _receive(conn); };
+    };
+
+    void _startTLS(_connection& conn) {
+
+        conn.ssl = SSL_new(_ctx);
+        if (conn.ssl == nullptr) { return _fail(conn, "Failed to create SSL object"); };
+        SSL_set_bio(conn.ssl, BIO_new(BIO_s_mem()), BIO_new(BIO_s_mem()));
+        SSL_set_connect_state(conn.ssl);
+        SSL_set_tlsext_host_name(conn.ssl, _host.c_str());
+        SSL_set1_host(conn.ssl, _host.c_str());
+        if (_session != nullptr) { SSL_set_session(conn.ssl, _session); };
+
+        conn.state = _states::HANDSHAKING;
+        _setEvents(conn, eventLoop::READABLE);
+        _handshake(conn);
+    };
+
+    // returns false if the connection was closed
+    bool _handshake(_connection& conn) {
+
+        const int ret = SSL_do_handshake(conn.ssl);
+        if (ret != 1) {
+
+            const int err = SSL_get_error(conn.ssl, ret);
+            if (err != SSL_ERROR_WANT_READ && err != SSL_ERROR_WANT_WRITE) {
+
+                const long verify = SSL_get_verify_result(conn.ssl);
+                _fail(conn, (verify != X509_V_OK) ?
+                                FMT("TLS handshake failed ({0})", X509_verify_cert_error_string(verify)) :
+                                FMT("TLS handshake failed ({0})", ERR_error_string(ERR_get_error(), nullptr)));
+                return false;
+            };
+            return _flush(conn);
+        };
+
+        if (!_flush(conn)) { return false; };
+        (SSL_session_reused(conn.ssl) != 0) ? _counts.resumed++ : _counts.full++;
+        _saveSession(conn);
+
+        conn.state = _states::READY;
+        _dispatch();
+        return conn.state != _states::CLOSED;
+    };
+
+    // sends the next queued request
+    void _start(_connection& conn) {
+
+        conn.job = std::move(_queue.front());
+        _queue.pop_front();
+        conn.parser.reset();
+        conn.state = _states::BUSY;
+
+        // memory BIOs don't block, so the whole request is written at once
+        SSL_write(conn.ssl, conn.job.bytes.data(), static_cast<int>(conn.job.bytes.size()));
+        _flush(conn);
+    };
+
+    // sends bytes encrypted by SSL. Returns false if the connection was closed
+    bool _flush(_connection& conn) {
+
+        BIO* wbio = SSL_get_wbio(conn.ssl);
+        char buf[16384];
+        int read = 0;
+        while ((read = BIO_read(wbio, buf, sizeof(buf))) > 0) { conn.out.append(buf, static_cast<size_t>(read)); };
+
+        while (conn.outPos < conn.out.size()) {
+
+            const ssize_t sent =
+                ::send(conn.fd, conn.out.data() + conn.outPos, conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+            if (sent < 0) {
+
+                if (errno == EINTR) { continue; };
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    _setEvents(conn, eventLoop::READABLE | eventLoop::WRITABLE);
+                    return true;
+                };
+                _fail(conn, FMT("Failed to send request ({0})", std::strerror(errno)));
+                return false;
+            };
+            conn.outPos += static_cast<size_t>(sent);
+        };
+
+        conn.out.clear();
+        conn.outPos = 0;
+        _setEvents(conn, eventLoop::READABLE);
+        return true;
+    };
+
+    void _receive(_connection& conn) {
+
+        char buf[16384];
+        while (true) {
+
+            const ssize_t rcvd = ::recv(conn.fd, buf, sizeof(buf), 0);
+            if (rcvd < 0) {
+
+                if (errno == EINTR) { continue; };
+                if (errno == EAGAIN || errno == EWOULDBLOCK) { return; };
+                return _fail(conn, FMT("Failed to receive response ({0})", std::strerror(errno)));
+            };
+            if (rcvd == 0) { return _onClose(conn); };
+
+            BIO_write(SSL_get_rbio(conn.ssl), buf, static_cast<int>(rcvd));
+            if (!_process(conn)) { return; };
+        };
+    };
+
+    // processes received bytes. Returns false if the connection was closed
+    bool _process(_connection& conn) {
+
+        if (conn.state == _states::HANDSHAKING) {
+            if (!_handshake(conn) || conn.state == _states::HANDSHAKING) { return conn.state != _states::CLOSED; };
+        };
+
+        char buf[16384];
+        while (true) {
+
+            const int read = SSL_read(conn.ssl, buf, sizeof(buf));
+            if (read <= 0) {
+
+                const int err = SSL_get_error(conn.ssl, read);
+                if (err == SSL_ERROR_WANT_READ) { return _flush(conn); };
+                if (err == SSL_ERROR_ZERO_RETURN) {
+                    _onClose(conn);
+                    return false;
+                };
+                _fail(conn, FMT("Failed to decrypt response ({0})", ERR_error_string(ERR_get_error(), nullptr)));
+                return false;
+            };
+
+            if (conn.state != _states::BUSY) {
+                _fail(conn, "Unexpected data was received");
+                return false;
+            };
+
+            bool complete = false;
+            try {
+                complete = conn.parser.feed(buf, static_cast<size_t>(read));
+            } catch (const libException&) {
+                _fail(conn, "Malformed response was received");
+                return false;
+            };
+            if (complete) {
+                _complete(conn);
+                if (conn.state == _states::CLOSED) { return false; };
+            };
+        };
+    };
+
+    void _onClose(_connection& conn) {
+
+        if (conn.state == _states::BUSY) {
+            if (conn.parser.finish()) { return _complete(conn); };
+            return _fail(conn, "Connection was closed before the response was received");
+        };
+
+        // idle connections closed by the server are opened again when needed
+        if (conn.state == _states::READY) {
+            _close(conn);
+            return _dispatch();
+        };
+        _fail(conn, "Connection was closed during the handshake");
+    };
+
+    void _complete(_connection& conn) {
+
+        // TLS 1.3 session tickets arrive after the handshake, so the session is saved again once they're in
+        _saveSession(conn);
+        responseCallback cb = std::move(conn.job.cb);
+        const int code = conn.parser.code;
+        string body = std::move(conn.parser.body);
+
+        if (conn.parser.keepAlive) {
+            conn.state = _states::READY;
+        } else {
+            _close(conn);
+        };
+
+        std::exception_ptr error;
+        if (code != 200) {
+
+            try {
+                kc::_throwException(kite::_apiErrorOf(body, code));
+            } catch (...) { error = std::current_exception(); };
+        };
+        if (cb) { cb(body, error); };
+
+        _dispatch();
+    };
+
+    void _armTimer(int64_t deadline) {
+
+        _timerAt = deadline;
+        itimerspec spec {};
+        if (deadline != 0) {
+            // a zero it_value would disarm the timer, so deadlines that have passed fire after a nanosecond
+            const int64_t in = std::max<int64_t>(deadline - _steadyNs(), 1);
+            spec.it_value.tv_sec = static_cast<time_t>(in / 1000000000);
+            spec.it_value.tv_nsec = static_cast<long>(in % 1000000000);
+        };
+        timerfd_settime(_timerFd, 0, &spec, nullptr);
+    };
+
+    // fails requests whose deadline has passed and arms the timer for the earliest of the rest
+    void _onTimer() {
+
+        uint64_t expirations = 0;
+        while (::read(_timerFd, &expirations, sizeof(expirations)) > 0) {};
+        _timerAt = 0;
+
+        const int64_t now = _steadyNs();
+        for (auto& conn : _connections) {
+            // the response may still arrive, so the connection can't be used for other requests
+            if (conn.state == _states::BUSY && conn.job.deadline <= now) { _fail(conn, "Request timed out"); };
+        };
+
+        std::vector<responseCallback> expired;
+        for (auto it = _queue.begin(); it != _queue.end();) {
+            if (it->deadline <= now) {
+                expired.push_back(std::move(it->cb));
+                it = _queue.erase(it);
+            } else {
+                ++it;
+            };
+        };
+        if (!expired.empty()) {
+
+            std::exception_ptr error =
+                std::make_exception_ptr(libException("Request timed out before it could be sent (asyncClient)"));
+            string empty;
+            for (auto& cb : expired) {
+                if (cb) { cb(empty, error); };
+            };
+        };
+
+        int64_t earliest = 0;
+        for (const auto& conn : _connections) {
+            if (conn.state == _states::BUSY && (earliest == 0 || conn.job.deadline < earliest)) {
+                earliest = conn.job.deadline;
+            };
+        };
+        for (const auto& job : _queue) {
+            if (earliest == 0 || job.deadline < earliest) { earliest = job.deadline; };
+        };
+        if (earliest != 0 && (_timerAt == 0 || earliest < _timerAt)) { _armTimer(earliest); };
+    };
+
+    // keeps the session of the connection for resuming it on reconnects
+    void _saveSession(_connection& conn) {
+
+        SSL_SESSION* session = SSL_get1_session(conn.ssl);
+        if (session == nullptr) { return; };
+        if (SSL_SESSION_is_resumable(session) == 0 || session == _session) {
+            SSL_SESSION_free(session);
+            return;
+        };
+        if (_session != nullptr) { SSL_SESSION_free(_session); };
+        _session = session;
+    };
+
+    void _setEvents(_connection& conn, int events) {
+
+        if (conn.events == events) { return; };
+        conn.events = events;
+        _loop.change(conn.fd, events);
+    };
+
+    // wraps an order callback into one that extracts the order ID from the response
+    static responseCallback _orderIDOf(orderCallback cb, const char* caller) {
+
+        return [cb = std::move(cb), caller](string& body, std::exception_ptr error) {
+
+            string ordID;
+            if (!error) {
+
+                try {
+                    rju::_document res;
+                    if (!body.empty()) { res.parse(std::move(body)); };
+                    if (!res.IsObject()) {
+                        throw libException(FMT("Empty data was received where it wasn't expected ({0})", caller));
+                    };
+                    rju::_getIfExists(res["data"].GetObject(), ordID, "order_id");
+                } catch (...) { error = std::current_exception(); };
+            };
+            if (cb) { cb(ordID, error); };
+        };
+    };
+};
+
+} // namespace kiteconnect
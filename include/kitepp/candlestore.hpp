@@ -0,0 +1,444 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+#include "config.hpp"
+#include "historicaldownloader.hpp"
+#include "kite.hpp"
+#include "kiteppexceptions.hpp"
+#include "responses.hpp"
+#include "utils.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/**
+ * @brief Local, persistent store of historical candles that only downloads what it doesn't have yet.
+ *
+ * Every series (instrument token, interval, continuous and OI flags) is kept in two files. The data file is append
+ * only and holds blocks of candles in column-wise form. The index file lists the blocks along with the time range
+ * each of them covers and is replaced atomically after every append. `get()` requests only the parts of the range
+ * that aren't covered yet, appends them and serves the whole range from disk.
+ *
+ * Candles that haven't closed yet when fetched are returned but not stored, so they're fetched again next time.
+ */
+class candleStore {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new candleStore object
+     *
+     * @param Kite kite object used for downloading missing candles
+     * @param directory directory the files are stored in. Must exist
+     */
+    candleStore(kite& Kite, string directory): _kite(Kite), _directory(std::move(directory)) {};
+
+    // methods
+
+    /**
+     * @brief Same as `kite::getHistoricalCandles()` but served from the store, downloading only the missing ranges
+     *
+     * @param instrumentTok instrument token (NOT trading symbol)
+     * @param from from date in the following format: yyyy-mm-dd HH:MM:SS or yyyy-mm-dd
+     * @param to to date in the following format: yyyy-mm-dd HH:MM:SS or yyyy-mm-dd
+     * @param interval candle interval
+     * @param continuous boolean flag to get continuous data for futures and options instruments
+     * @param oi boolean flag to get open interest data
+     *
+     * @return historicalCandles
+     */
+    historicalCandles get(int instrumentTok, const string& from, const string& to, const string& interval,
+        bool continuous = false, bool oi = false) {
+
+        const int64_t fromSec = _toSeconds(from, false);
+        const int64_t toSec = _toSeconds(to, true);
+        if (toSec < fromSec) { throw libException("`to` is before `from` (candleStore)"); };
+
+        const string path = getPath(instrumentTok, interval, continuous, oi);
+        std::lock_guard<std::mutex> lock(_mtx);
+
+        std::vector<_segment> index = _readIndex(path + ".idx");
+        std::vector<_row> fresh; // fetched candles that haven't closed yet
+        const auto gaps = _findGaps(index, fromSec, toSec);
+        if (!gaps.empty()) {
+
+            const int64_t maxSpan = static_cast<int64_t>(historicalDownloader::getMaxDays(interval)) * 86400;
+            const int64_t now =
+                std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+                    .count();
+            const int64_t lastClosed = now - _intervalSeconds(interval); // latest start of a closed candle
+
+            for (const auto& gap : gaps) {
+                for (int64_t start = gap.first; start <= gap.second; start += maxSpan) {
+
+                    const int64_t end = std::min(gap.second, start + maxSpan - 1);
+                    historicalCandles candles = _kite.getHistoricalCandles(
+                        instrumentTok, _formatSeconds(start), _formatSeconds(end), interval, continuous, oi);
+
+                    std::vector<_row> closed;
+                    for (auto& row : _toRows(candles, 0)) {
+                        (row.ts / 1000000000 <= lastClosed ? closed : fresh).push_back(row);
+                    };
+
+                    const int64_t coveredTo = std::min(end, lastClosed);
+                    if (coveredTo >= start) { _append(path, index, start, coveredTo, closed); };
+                };
+            };
+        };
+
+        return _read(path, index, fromSec, toSec, std::move(fresh));
+    };
+
+    /**
+     * @brief Delete stored candles of a series
+     *
+     * @param instrumentTok
+     * @param interval
+     * @param continuous
+     * @param oi
+     */
+    void remove(int instrumentTok, const string& interval, bool continuous = false, bool oi = false) {
+
+        const string path = getPath(instrumentTok, interval, continuous, oi);
+        std::lock_guard<std::mutex> lock(_mtx);
+        std::remove((path + ".idx").c_str());
+        std::remove((path + ".dat").c_str());
+    };
+
+    /**
+     * @brief Get path (without extension) of the files a series is stored in
+     *
+     * @param instrumentTok
+     * @param interval
+     * @param continuous
+     * @param oi
+     *
+     * @return string
+     */
+    string getPath(int instrumentTok, const string& interval, bool continuous = false, bool oi = false) const {
+        return FMT("{0}/candles_{1}_{2}_{3}{4}", _directory, instrumentTok, interval, static_cast<int>(continuous),
+            static_cast<int>(oi));
+    };
+
+  private:
+    struct _indexHeader {
+
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t count;
+    };
+
+    // a block of candles in the data file. Columns of a block are stored back to back
+    struct _segment {
+
+        int64_t from;    // covered range in seconds since the unix epoch, inclusive
+        int64_t to;
+        uint64_t offset; // of the block in the data file
+        uint64_t rows;
+    };
+
+    struct _row {
+
+        int64_t ts;
+        double open;
+        double high;
+        double low;
+        double close;
+        int64_t volume;
+        int64_t OI;
+        uint64_t seq; // segment the row came from. rows of later segments win on duplicates
+    };
+
+    static_assert(sizeof(_indexHeader) == 24, "unexpected padding in candle index header");
+    static_assert(sizeof(_segment) == 32, "unexpected padding in candle index segment");
+
+    static constexpr char _magic[8] = { 'K', 'P', 'P', 'C', 'N', 'D', 'L', '\0' };
+    static constexpr uint32_t _version = 1;
+    static constexpr uint32_t _byteOrder = 0x01020304;
+    static constexpr size_t _rowSize = 7 * 8; // bytes per candle in the data file
+
+    // member variables
+
+    kite& _kite;
+    const string _directory;
+    std::mutex _mtx;
+
+    // methods
+
+    // converts an IST date or date-time to seconds since the unix epoch. Dates without time refer to the start or the
+    // end of the day
+    static int64_t _toSeconds(const string& str, bool endOfDay) {
+
+        int64_t ns = 0;
+        const string withTime = (str.size() == 10) ? str + (endOfDay ? " 23:59:59" : " 00:00:00") : str;
+        if (!kc::_parseISO8601(withTime + "+05:30", ns)) {
+            throw libException(FMT("Invalid date {0} (candleStore)", str));
+        };
+
+        return ns / 1000000000;
+    };
+
+    // formats seconds since the unix epoch as an IST `yyyy-mm-dd hh:mm:ss` string
+    static string _formatSeconds(int64_t seconds) {
+
+        const int64_t ist = seconds + 5 * 3600 + 30 * 60;
+        const int64_t days = (ist >= 0) ? ist / 86400 : (ist - 86399) / 86400;
+        const int64_t secs = ist - days * 86400;
+
+        return FMT("{0} {1:02d}:{2:02d}:{3:02d}", kc::_formatDate(static_cast<int32_t>(days)), secs / 3600,
+            (secs / 60) % 60, secs % 60);
+    };
+
+    static int64_t _intervalSeconds(const string& interval) {
+
+        if (interval == "day") { return 86400; };
+        if (interval == "minute") { return 60; };
+
+        // Nminute
+        const size_t pos = interval.find("minute");
+        if (pos == 0 || pos == string::npos) {
+            throw libException(FMT("Unknown interval {0} (candleStore)", interval));
+        };
+
+        return std::stoll(interval.substr(0, pos)) * 60;
+    };
+
+    // parts of [from, to] that aren't covered by any segment
+    static std::vector<std::pair<int64_t, int64_t>> _findGaps(
+        const std::vector<_segment>& index, int64_t from, int64_t to) {
+
+        std::vector<std::pair<int64_t, int64_t>> covered;
+        covered.reserve(index.size());
+        for (const auto& seg : index) { covered.emplace_back(seg.from, seg.to); };
+        std::sort(covered.begin(), covered.end());
+
+        std::vector<std::pair<int64_t, int64_t>> gaps;
+        int64_t cursor = from;
+        for (const auto& range : covered) {
+
+            if (cursor > to) { break; };
+            if (range.second < cursor) { continue; };
+            if (range.first > cursor) { gaps.emplace_back(cursor, std::min(to, range.first - 1)); };
+            cursor = std::max(cursor, range.second + 1);
+        };
+        if (cursor <= to) { gaps.emplace_back(cursor, to); };
+
+        return gaps;
+    };
+
+    static std::vector<_row> _toRows(const historicalCandles& candles, uint64_t seq) {
+
+        std::vector<_row> rows;
+        rows.reserve(candles.size());
+        for (size_t i = 0; i < candles.size(); i++) {
+            rows.push_back({ candles.timestamps[i], candles.open[i], candles.high[i], candles.low[i], candles.close[i],
+                candles.volume[i], candles.OI[i], seq });
+        };
+
+        return rows;
+    };
+
+    static std::vector<_segment> _readIndex(const string& path) {
+
+        std::vector<_segment> index;
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr) { return index; };
+
+        _indexHeader hdr {};
+        bool ok = std::fread(&hdr, sizeof(hdr), 1, file) == 1 && std::memcmp(hdr.magic, _magic, sizeof(_magic)) == 0 &&
+                  hdr.version == _version && hdr.byteOrder == _byteOrder;
+        if (ok) {
+            index.resize(hdr.count);
+            ok = hdr.count == 0 || std::fread(index.data(), sizeof(_segment), hdr.count, file) == hdr.count;
+        };
+        std::fclose(file);
+
+        if (!ok) { throw libException(FMT("Corrupt candle index {0} (candleStore)", path)); };
+        return index;
+    };
+
+    static void _writeIndex(const string& path, const std::vector<_segment>& index) {
+
+        _indexHeader hdr {};
+        std::memcpy(hdr.magic, _magic, sizeof(hdr.magic));
+        hdr.version = _version;
+        hdr.byteOrder = _byteOrder;
+        hdr.count = index.size();
+
+        const string tmpPath = path + ".tmp";
+        std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+        if (file == nullptr) { throw libException(FMT("Failed to open {0} for writing", tmpPath)); };
+
+        bool ok = std::fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+        if (ok && !index.empty()) {
+            ok = std::fwrite(index.data(), sizeof(_segment), index.size(), file) == index.size();
+        };
+        ok = _close(file) && ok;
+
+#ifdef _WIN32
+        // rename() doesn't replace existing files on windows
+        if (ok) { std::remove(path.c_str()); };
+#endif
+        if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            throw libException(FMT("Failed to write candle index {0}", path));
+        };
+    };
+
+    // flushes, syncs and closes file
+    static bool _close(std::FILE* file) {
+
+        bool ok = std::fflush(file) == 0;
+#ifndef _WIN32
+        ok = (::fsync(::fileno(file)) == 0) && ok;
+#endif
+        return (std::fclose(file) == 0) && ok;
+    };
+
+    // appends a block to the data file and then records it in the index. A crash in between leaves unreferenced bytes
+    // at the end of the data file, which are never read
+    static void _append(
+        const string& path, std::vector<_segment>& index, int64_t from, int64_t to, const std::vector<_row>& rows) {
+
+        const string dataPath = path + ".dat";
+        std::FILE* file = std::fopen(dataPath.c_str(), "ab");
+        if (file == nullptr) { throw libException(FMT("Failed to open {0} for writing", dataPath)); };
+
+        std::fseek(file, 0, SEEK_END);
+        const long offset = std::ftell(file);
+
+        const size_t n = rows.size();
+        std::vector<int64_t> ints(n);
+        std::vector<double> doubles(n);
+        bool ok = offset >= 0;
+        const auto writeInts = [&](int64_t _row::*field) {
+            for (size_t i = 0; i < n; i++) { ints[i] = rows[i].*field; };
+            ok = ok && (n == 0 || std::fwrite(ints.data(), sizeof(int64_t), n, file) == n);
+        };
+        const auto writeDoubles = [&](double _row::*field) {
+            for (size_t i = 0; i < n; i++) { doubles[i] = rows[i].*field; };
+            ok = ok && (n == 0 || std::fwrite(doubles.data(), sizeof(double), n, file) == n);
+        };
+        writeInts(&_row::ts);
+        writeDoubles(&_row::open);
+        writeDoubles(&_row::high);
+        writeDoubles(&_row::low);
+        writeDoubles(&_row::close);
+        writeInts(&_row::volume);
+        writeInts(&_row::OI);
+        ok = _close(file) && ok;
+        if (!ok) { throw libException(FMT("Failed to append candles to {0}", dataPath)); };
+
+        index.push_back({ from, to, static_cast<uint64_t>(offset), n });
+        _writeIndex(path + ".idx", index);
+    };
+
+    static historicalCandles _read(
+        const string& path, const std::vector<_segment>& index, int64_t from, int64_t to, std::vector<_row>&& fresh) {
+
+        const int64_t fromNs = from * 1000000000;
+        const int64_t toNs = to * 1000000000 + 999999999;
+
+        std::vector<_row> rows;
+        std::FILE* file = nullptr;
+        for (size_t s = 0; s < index.size(); s++) {
+
+            const _segment& seg = index[s];
+            if (seg.to < from || seg.from > to || seg.rows == 0) { continue; };
+
+            if (file == nullptr) {
+                file = std::fopen((path + ".dat").c_str(), "rb");
+                if (file == nullptr) { throw libException(FMT("Failed to open {0}.dat (candleStore)", path)); };
+            };
+
+            const size_t n = seg.rows;
+            std::vector<unsigned char> block(n * _rowSize);
+            if (std::fseek(file, static_cast<long>(seg.offset), SEEK_SET) != 0 ||
+                std::fread(block.data(), _rowSize, n, file) != n) {
+                std::fclose(file);
+                throw libException(FMT("Corrupt candle data {0}.dat (candleStore)", path));
+            };
+
+            const auto column = [&block, n](size_t col, size_t i, auto& out) {
+                std::memcpy(&out, block.data() + (col * n + i) * 8, 8);
+            };
+            for (size_t i = 0; i < n; i++) {
+
+                _row row {};
+                column(0, i, row.ts);
+                if (row.ts < fromNs || row.ts > toNs) { continue; };
+                column(1, i, row.open);
+                column(2, i, row.high);
+                column(3, i, row.low);
+                column(4, i, row.close);
+                column(5, i, row.volume);
+                column(6, i, row.OI);
+                row.seq = s;
+                rows.push_back(row);
+            };
+        };
+        if (file != nullptr) { std::fclose(file); };
+
+        for (auto& row : fresh) {
+            if (row.ts < fromNs || row.ts > toNs) { continue; };
+            row.seq = index.size();
+            rows.push_back(row);
+        };
+
+        // order by time, newest copy of a candle first, and drop the other copies
+        std::sort(rows.begin(), rows.end(),
+            [](const _row& a, const _row& b) { return (a.ts != b.ts) ? a.ts < b.ts : a.seq > b.seq; });
+        rows.erase(std::unique(rows.begin(), rows.end(), [](const _row& a, const _row& b) { return a.ts == b.ts; }),
+            rows.end());
+
+        historicalCandles candles;
+        candles.reserve(rows.size());
+        for (const auto& row : rows) {
+            candles.timestamps.push_back(row.ts);
+            candles.open.push_back(row.open);
+            candles.high.push_back(row.high);
+            candles.low.push_back(row.low);
+            candles.close.push_back(row.close);
+            candles.volume.push_back(row.volume);
+            candles.OI.push_back(row.OI);
+        };
+
+        return candles;
+    };
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,454 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has compact variants of the order, trade, position, holding and GTT responses. Values that come from a
+// known vocabulary (exchanges, products etc.) are stored as enums and other strings as views into the response body,
+// which is owned by the result
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "fieldtable.hpp"
+#include "saxparser.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+// clang-format off
+/// exchanges listed in userconstants.hpp
+enum class exchangeID : uint8_t { OTHER, NSE, BSE, NFO, CDS, BFO, MCX };
+/// products listed in userconstants.hpp
+enum class productID : uint8_t { OTHER, MIS, CNC, NRML, CO, BO };
+/// order types listed in userconstants.hpp
+enum class orderTypeID : uint8_t { OTHER, MARKET, LIMIT, SLM, SL };
+/// varieties listed in userconstants.hpp
+enum class varietyID : uint8_t { OTHER, REGULAR, BO, CO, AMO };
+/// transaction types listed in userconstants.hpp
+enum class transactionTypeID : uint8_t { OTHER, BUY, SELL };
+/// validities listed in userconstants.hpp
+enum class validityID : uint8_t { OTHER, DAY, IOC };
+/// order statuses listed in userconstants.hpp
+enum class statusID : uint8_t { OTHER, COMPLETE, REJECTED, CANCELLED };
+/// GTT types listed in userconstants.hpp
+enum class GTTTypeID : uint8_t { OTHER, OCO, SINGLE };
+/// GTT statuses listed in userconstants.hpp
+enum class GTTStatusID : uint8_t { OTHER, ACTIVE, TRIGGERED, DISABLED, EXPIRED, CANCELLED, REJECTED, DELETED };
+
+// names of the values of a vocabulary, indexed by the enum. OTHER has no name
+template <typename E> struct _vocabulary;
+
+template <> struct _vocabulary<exchangeID> {
+    static constexpr std::array<std::string_view, 7> names = { "", "NSE", "BSE", "NFO", "CDS", "BFO", "MCX" };
+};
+template <> struct _vocabulary<productID> {
+    static constexpr std::array<std::string_view, 6> names = { "", "MIS", "CNC", "NRML", "CO", "BO" };
+};
+template <> struct _vocabulary<orderTypeID> {
+    static constexpr std::array<std::string_view, 5> names = { "", "MARKET", "LIMIT", "SL-M", "SL" };
+};
+template <> struct _vocabulary<varietyID> {
+    static constexpr std::array<std::string_view, 5> names = { "", "regular", "bo", "co", "amo" };
+};
+template <> struct _vocabulary<transactionTypeID> {
+    static constexpr std::array<std::string_view, 3> names = { "", "BUY", "SELL" };
+};
+template <> struct _vocabulary<validityID> {
+    static constexpr std::array<std::string_view, 3> names = { "", "DAY", "IOC" };
+};
+template <> struct _vocabulary<statusID> {
+    static constexpr std::array<std::string_view, 4> names = { "", "COMPLETE", "REJECTED", "CANCELLED" };
+};
+template <> struct _vocabulary<GTTTypeID> {
+    static constexpr std::array<std::string_view, 3> names = { "", "two-leg", "single" };
+};
+template <> struct _vocabulary<GTTStatusID> {
+    static constexpr std::array<std::string_view, 8> names = { "", "active", "triggered", "disabled", "expired",
+        "cancelled", "rejected", "deleted" };
+};
+// clang-format on
+
+/**
+ * @brief A value from a known vocabulary. Values that aren't in the vocabulary are kept as `OTHER` along with the
+ * value itself
+ *
+ * @tparam E enum of the vocabulary
+ */
+template <typename E> struct vocab {
+
+    /**
+     * @brief the value as sent by the API
+     *
+     * @return std::string_view
+     */
+    std::string_view str() const {
+        return (id != E::OTHER) ? _vocabulary<E>::names[static_cast<size_t>(id)] : std::string_view(other);
+    };
+
+    bool operator==(E e) const { return id == e; };
+    bool operator!=(E e) const { return id != e; };
+
+    E id = E::OTHER;
+    const char* other = ""; // value if it isn't in the vocabulary. Points into the result's body
+};
+
+// strings of a parsed body are null-terminated, so `other` can point to them as they are
+template <typename E> bool _saxAssign(vocab<E>& out, const _saxValue& val) {
+
+    if (val.type == _saxValue::types::NUL) {
+        out = vocab<E>();
+        return true;
+    };
+    if (val.type != _saxValue::types::STRING) { return false; };
+
+    const auto& names = _vocabulary<E>::names;
+    for (size_t i = 1; i < names.size(); i++) {
+        if (names[i] == val.str) {
+            out.id = static_cast<E>(i);
+            out.other = "";
+            return true;
+        };
+    };
+    out.id = E::OTHER;
+    out.other = val.str.data();
+
+    return true;
+};
+
+template <typename E> struct _saxIsScalar<vocab<E>> {
+    static constexpr bool value = true;
+};
+
+/**
+ * @brief Result of a compact request. Owns the response body that the string views of `data` point into, so it can be
+ * moved but not copied
+ *
+ * @tparam T type of the data
+ */
+template <typename T> class compactResult {
+
+  public:
+    // member variables
+
+    T data;
+
+    // constructors and destructor
+
+    compactResult() = default;
+    compactResult(compactResult&&) noexcept = default;
+    compactResult& operator=(compactResult&&) noexcept = default;
+    compactResult(const compactResult&) = delete;
+    compactResult& operator=(const compactResult&) = delete;
+
+  private:
+    friend class kite;
+
+    // member variables
+
+    std::unique_ptr<string> _body;
+};
+
+/// compact variant of `order`
+struct compactOrder {
+
+    std::string_view accountID;
+    std::string_view placedBy;
+
+    std::string_view orderID;
+    std::string_view exchangeOrderID;
+    std::string_view parentOrderID;
+    vocab<statusID> status;
+    std::string_view statusMessage;
+    std::string_view orderTimestamp;
+    std::string_view exchangeUpdateTimestamp;
+    std::string_view exchangeTimestamp;
+    std::string_view rejectedBy;
+    vocab<varietyID> variety;
+
+    vocab<exchangeID> exchange;
+    std::string_view tradingSymbol;
+    int instrumentToken = 0;
+
+    vocab<orderTypeID> orderType;
+    vocab<transactionTypeID> transactionType;
+    vocab<validityID> validity;
+    vocab<productID> product;
+    int quantity = 0;
+    int disclosedQuantity = 0;
+    double price = 0.0;
+    double triggerPrice = 0.0;
+
+    double averagePrice = 0.0;
+    int filledQuantity = 0;
+    int pendingQuantity = 0;
+    int cancelledQuantity = 0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("account_id", &compactOrder::accountID),
+        kc::_field("placed_by", &compactOrder::placedBy),
+        kc::_field("order_id", &compactOrder::orderID),
+        kc::_field("exchange_order_id", &compactOrder::exchangeOrderID),
+        kc::_field("parent_order_id", &compactOrder::parentOrderID),
+        kc::_field("status", &compactOrder::status),
+        kc::_field("status_message", &compactOrder::statusMessage),
+        kc::_field("order_timestamp", &compactOrder::orderTimestamp),
+        kc::_field("exchange_update_timestamp", &compactOrder::exchangeUpdateTimestamp),
+        kc::_field("exchange_timestamp", &compactOrder::exchangeTimestamp),
+        kc::_field("rejected_by", &compactOrder::rejectedBy),
+        kc::_field("variety", &compactOrder::variety),
+        kc::_field("exchange", &compactOrder::exchange),
+        kc::_field("tradingsymbol", &compactOrder::tradingSymbol),
+        kc::_field("instrument_token", &compactOrder::instrumentToken),
+        kc::_field("order_type", &compactOrder::orderType),
+        kc::_field("transaction_type", &compactOrder::transactionType),
+        kc::_field("validity", &compactOrder::validity),
+        kc::_field("product", &compactOrder::product),
+        kc::_field("quantity", &compactOrder::quantity),
+        kc::_field("disclosed_quantity", &compactOrder::disclosedQuantity),
+        kc::_field("price", &compactOrder::price),
+        kc::_field("trigger_price", &compactOrder::triggerPrice),
+        kc::_field("average_price", &compactOrder::averagePrice),
+        kc::_field("filled_quantity", &compactOrder::filledQuantity),
+        kc::_field("pending_quantity", &compactOrder::pendingQuantity),
+        kc::_field("cancelled_quantity", &compactOrder::cancelledQuantity)
+    );
+    // clang-format on
+};
+
+/// compact variant of `trade`
+struct compactTrade {
+
+    double averagePrice = 0.0;
+    double quantity = 0.0;
+    std::string_view tradeID;
+    vocab<productID> product;
+    std::string_view fillTimestamp;
+    std::string_view exchangeTimestamp;
+    std::string_view exchangeOrderID;
+    std::string_view orderID;
+    vocab<transactionTypeID> transactionType;
+    std::string_view tradingSymbol;
+    vocab<exchangeID> exchange;
+    int instrumentToken = 0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("average_price", &compactTrade::averagePrice),
+        kc::_field("quantity", &compactTrade::quantity),
+        kc::_field("trade_id", &compactTrade::tradeID),
+        kc::_field("product", &compactTrade::product),
+        kc::_field("fill_timestamp", &compactTrade::fillTimestamp),
+        kc::_field("exchange_timestamp", &compactTrade::exchangeTimestamp),
+        kc::_field("exchange_order_id", &compactTrade::exchangeOrderID),
+        kc::_field("order_id", &compactTrade::orderID),
+        kc::_field("transaction_type", &compactTrade::transactionType),
+        kc::_field("tradingsymbol", &compactTrade::tradingSymbol),
+        kc::_field("exchange", &compactTrade::exchange),
+        kc::_field("instrument_token", &compactTrade::instrumentToken)
+    );
+    // clang-format on
+};
+
+/// compact variant of `position`
+struct compactPosition {
+
+    std::string_view tradingsymbol;
+    vocab<exchangeID> exchange;
+    int instrumentToken = 0;
+    vocab<productID> product;
+
+    int quantity = 0;
+    int overnightQuantity = 0;
+    double multiplier = 0.0;
+
+    double averagePrice = 0.0;
+    double closePrice = 0.0;
+    double lastPrice = 0.0;
+    double value = 0.0;
+    double PnL = 0.0;
+    double M2M = 0.0;
+    double unrealised = 0.0;
+    double realised = 0.0;
+
+    int buyQuantity = 0;
+    double buyPrice = 0.0;
+    double buyValue = 0.0;
+    double buyM2MValue = 0.0;
+
+    int sellQuantity = 0;
+    double sellPrice = 0.0;
+    double sellValue = 0.0;
+    double sellM2MValue = 0.0;
+
+    int dayBuyQuantity = 0;
+    double dayBuyPrice = 0.0;
+    double dayBuyValue = 0.0;
+
+    int daySellQuantity = 0;
+    double daySellPrice = 0.0;
+    double daySellValue = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("tradingsymbol", &compactPosition::tradingsymbol),
+        kc::_field("exchange", &compactPosition::exchange),
+        kc::_field("instrument_token", &compactPosition::instrumentToken),
+        kc::_field("product", &compactPosition::product),
+        kc::_field("quantity", &compactPosition::quantity),
+        kc::_field("overnight_quantity", &compactPosition::overnightQuantity),
+        kc::_field("multiplier", &compactPosition::multiplier),
+        kc::_field("average_price", &compactPosition::averagePrice),
+        kc::_field("close_price", &compactPosition::closePrice),
+        kc::_field("last_price", &compactPosition::lastPrice),
+        kc::_field("value", &compactPosition::value),
+        kc::_field("pnl", &compactPosition::PnL),
+        kc::_field("m2m", &compactPosition::M2M),
+        kc::_field("unrealised", &compactPosition::unrealised),
+        kc::_field("realised", &compactPosition::realised),
+        kc::_field("buy_quantity", &compactPosition::buyQuantity),
+        kc::_field("buy_price", &compactPosition::buyPrice),
+        kc::_field("buy_value", &compactPosition::buyValue),
+        kc::_field("buy_m2m", &compactPosition::buyM2MValue),
+        kc::_field("sell_quantity", &compactPosition::sellQuantity),
+        kc::_field("sell_price", &compactPosition::sellPrice),
+        kc::_field("sell_value", &compactPosition::sellValue),
+        kc::_field("sell_m2m", &compactPosition::sellM2MValue),
+        kc::_field("day_buy_quantity", &compactPosition::dayBuyQuantity),
+        kc::_field("day_buy_price", &compactPosition::dayBuyPrice),
+        kc::_field("day_buy_value", &compactPosition::dayBuyValue),
+        kc::_field("day_sell_quantity", &compactPosition::daySellQuantity),
+        kc::_field("day_sell_price", &compactPosition::daySellPrice),
+        kc::_field("day_sell_value", &compactPosition::daySellValue)
+    );
+    // clang-format on
+};
+
+/// compact variant of `positions`
+struct compactPositions {
+
+    std::vector<compactPosition> net;
+    std::vector<compactPosition> day;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("net", &compactPositions::net),
+        kc::_field("day", &compactPositions::day)
+    );
+    // clang-format on
+};
+
+/// compact variant of `holding`
+struct compactHolding {
+
+    std::string_view tradingsymbol;
+    vocab<exchangeID> exchange;
+    int instrumentToken = 0;
+    std::string_view ISIN;
+    vocab<productID> product;
+
+    double price = 0.0;
+    int quantity = 0;
+    int t1Quantity = 0;
+    int realisedQuantity = 0;
+    int collateralQuantity = 0;
+    std::string_view collateralType;
+
+    double averagePrice = 0.0;
+    double lastPrice = 0.0;
+    double closePrice = 0.0;
+    double PnL = 0.0;
+    double dayChange = 0.0;
+    double dayChangePercentage = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("tradingsymbol", &compactHolding::tradingsymbol),
+        kc::_field("exchange", &compactHolding::exchange),
+        kc::_field("instrument_token", &compactHolding::instrumentToken),
+        kc::_field("isin", &compactHolding::ISIN),
+        kc::_field("product", &compactHolding::product),
+        kc::_field("price", &compactHolding::price),
+        kc::_field("quantity", &compactHolding::quantity),
+        kc::_field("t1_quantity", &compactHolding::t1Quantity),
+        kc::_field("realised_quantity", &compactHolding::realisedQuantity),
+        kc::_field("collateral_quantity", &compactHolding::collateralQuantity),
+        kc::_field("collateral_type", &compactHolding::collateralType),
+        kc::_field("average_price", &compactHolding::averagePrice),
+        kc::_field("last_price", &compactHolding::lastPrice),
+        kc::_field("close_price", &compactHolding::closePrice),
+        kc::_field("pnl", &compactHolding::PnL),
+        kc::_field("day_change", &compactHolding::dayChange),
+        kc::_field("day_change_percentage", &compactHolding::dayChangePercentage)
+    );
+    // clang-format on
+};
+
+/// compact variant of `GTTCondition`
+struct compactGTTCondition {
+
+    vocab<exchangeID> exchange;
+    std::string_view tradingsymbol;
+    double lastPrice = 0.0;
+    std::vector<double> triggerValues;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("exchange", &compactGTTCondition::exchange),
+        kc::_field("tradingsymbol", &compactGTTCondition::tradingsymbol),
+        kc::_field("last_price", &compactGTTCondition::lastPrice),
+        kc::_field("trigger_values", &compactGTTCondition::triggerValues)
+    );
+    // clang-format on
+};
+
+/// compact variant of `GTT`
+struct compactGTT {
+
+    int ID = 0;
+    std::string_view userID;
+    vocab<GTTTypeID> type;
+    std::string_view createdAt;
+    std::string_view updatedAt;
+    std::string_view expiresAt;
+    vocab<GTTStatusID> status;
+    compactGTTCondition condition;
+    std::vector<compactOrder> orders;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("id", &compactGTT::ID),
+        kc::_field("user_id", &compactGTT::userID),
+        kc::_field("type", &compactGTT::type),
+        kc::_field("created_at", &compactGTT::createdAt),
+        kc::_field("updated_at", &compactGTT::updatedAt),
+        kc::_field("expires_at", &compactGTT::expiresAt),
+        kc::_field("status", &compactGTT::status),
+        kc::_field("condition", &compactGTT::condition),
+        kc::_field("orders", &compactGTT::orders)
+    );
+    // clang-format on
+};
+
+} // namespace kiteconnect
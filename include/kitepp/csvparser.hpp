@@ -0,0 +1,215 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has a streaming CSV tokenizer used for parsing instrument dumps
+
+#pragma once
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "kiteppexceptions.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+// converts a CSV field to int. Empty fields are treated as 0
+inline int _toInt(std::string_view str) {
+
+    if (str.empty()) { return 0; };
+
+    int out = 0;
+    auto res = std::from_chars(str.data(), str.data() + str.size(), out);
+    if (res.ec != std::errc()) { throw libException(FMT("Failed to convert {0} to int", str)); };
+
+    return out;
+};
+
+// converts a CSV field to double. Empty fields are treated as 0.0
+inline double _toDouble(std::string_view str) {
+
+    if (str.empty()) { return 0.0; };
+
+    double out = 0.0;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto res = std::from_chars(str.data(), str.data() + str.size(), out);
+    if (res.ec != std::errc()) { throw libException(FMT("Failed to convert {0} to double", str)); };
+#else
+    // floating point from_chars() isn't available on every standard library yet
+    char buf[64];
+    if (str.size() >= sizeof(buf)) { throw libException(FMT("Failed to convert {0} to double", str)); };
+    std::memcpy(buf, str.data(), str.size());
+    buf[str.size()] = '\0';
+    char* end = nullptr;
+    out = std::strtod(buf, &end);
+    if (end != buf + str.size()) { throw libException(FMT("Failed to convert {0} to double", str)); };
+#endif
+
+    return out;
+};
+
+/*
+ Incremental CSV tokenizer. Data can be fed in chunks of any size (e.g., as it's being downloaded) and `onRow` is called
+ with fields of every complete row as soon as its terminator has been seen. Fields are views into the fed data whenever
+ possible, so they're only valid during the call. Only rows that span two chunks are copied. Handles quoted fields
+ (including escaped quotes, delimiters and line breaks in them) and both `\n` and `\r\n` line endings. Rows end only
+ at `\n`.
+*/
+template <typename OnRow> class _csvParser {
+
+  public:
+    explicit _csvParser(OnRow onRow, bool skipHeader = true): _onRow(std::move(onRow)), _skipHeader(skipHeader) {};
+
+    void feed(const char* data, size_t size) {
+
+        const char* p = data;
+        const char* end = data + size;
+
+        // complete the row left over by the previous chunk
+        while (!_carry.empty() && p < end) {
+
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            const char* upto = (nl != nullptr) ? nl + 1 : end;
+            _carry.append(p, upto);
+            p = upto;
+
+            if (nl == nullptr) { return; };
+            if (_parseRow(_carry.data(), _carry.data() + _carry.size()) != nullptr) {
+                _emit();
+                _carry.clear();
+            };
+        };
+
+        while (p < end) {
+
+            const char* next = _parseRow(p, end);
+            if (next == nullptr) {
+                _carry.assign(p, end);
+                return;
+            };
+
+            _emit();
+            p = next;
+        };
+    };
+
+    // parses the last row if the data didn't end with a line break
+    void finish() {
+
+        if (_carry.empty()) { return; };
+
+        _carry.push_back('\n');
+        if (_parseRow(_carry.data(), _carry.data() + _carry.size()) == nullptr) {
+            throw libException("CSV data ended inside a quoted field");
+        };
+        _emit();
+        _carry.clear();
+    };
+
+    size_t rows() const { return _rows; };
+
+  private:
+    OnRow _onRow;
+    bool _skipHeader = true;
+    size_t _rows = 0;
+    string _carry;
+    std::vector<std::string_view> _fields;
+    std::deque<string> _unescaped; // storage for quoted fields that had escaped quotes. references are stable
+
+    void _emit() {
+
+        // blank line
+        if (_fields.size() == 1 && _fields[0].empty()) { return; };
+
+        _rows++;
+        if (_skipHeader && _rows == 1) { return; };
+
+        _onRow(_fields);
+    };
+
+    // tokenizes a row starting at p into _fields. Returns pointer past the row's terminator or nullptr if the row isn't
+    // complete yet
+    const char* _parseRow(const char* p, const char* end) {
+
+        _fields.clear();
+        _unescaped.clear();
+
+        while (true) {
+
+            if (p == end) { return nullptr; };
+
+            if (*p == '"') {
+
+                const char* start = ++p;
+                bool escaped = false;
+                const char* q = nullptr;
+                while (true) {
+
+                    q = static_cast<const char*>(std::memchr(p, '"', end - p));
+                    // can't know whether the quote is escaped if it's the last char
+                    if (q == nullptr || q + 1 == end) { return nullptr; };
+                    if (q[1] != '"') { break; };
+
+                    escaped = true;
+                    p = q + 2;
+                };
+
+                if (escaped) {
+
+                    string& field = _unescaped.emplace_back();
+                    for (const char* c = start; c < q; c++) {
+                        field.push_back(*c);
+                        if (*c == '"') { c++; };
+                    };
+                    _fields.emplace_back(field);
+                } else {
+                    _fields.emplace_back(start, q - start);
+                };
+
+                p = q + 1;
+            } else {
+
+                const char* start = p;
+                while (p < end && *p != ',' && *p != '\n') { p++; };
+                if (p == end) { return nullptr; };
+
+                // drop \r of \r\n
+                const char* fieldEnd = (*p == '\n' && p > start && p[-1] == '\r') ? p - 1 : p;
+                _fields.emplace_back(start, fieldEnd - start);
+            };
+
+            if (p < end && *p == '\r') { p++; };
+            if (p == end) { return nullptr; };
+            if (*p == ',') {
+                p++;
+                continue;
+            };
+            if (*p == '\n') { return p + 1; };
+
+            throw libException("Unexpected character after a quoted CSV field");
+        };
+    };
+};
+
+} // namespace kiteconnect
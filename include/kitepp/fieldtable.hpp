@@ -0,0 +1,162 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has compile-time tables that map JSON keys to members of response structs
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace kiteconnect {
+
+/*
+ A response struct lists its members in a `static constexpr auto _fields` tuple:
+
+    static constexpr auto _fields = std::make_tuple(kc::_field("order_id", &order::orderID), ...);
+
+ _fieldTable<T> builds a perfect hash of the keys at compile time, so a JSON key is matched to its field with one hash
+ and one comparison.
+*/
+
+// a member of T read from a JSON key
+template <typename T, typename M> struct _field {
+
+    using type = M;
+
+    constexpr _field(std::string_view k, M T::*m): key(k), member(m) {};
+
+    M& of(T& obj) const { return obj.*member; };
+
+    std::string_view key;
+    M T::*member;
+};
+
+// a member of a member struct S, read from the object of T itself (e.g., profile fields of a userSession)
+template <typename T, typename S, typename M> struct _subField {
+
+    using type = M;
+
+    constexpr _subField(std::string_view k, S T::*o, M S::*m): key(k), outer(o), member(m) {};
+
+    M& of(T& obj) const { return (obj.*outer).*member; };
+
+    std::string_view key;
+    S T::*outer;
+    M S::*member;
+};
+
+// fields of member struct S, to be concatenated to the fields of T with std::tuple_cat()
+template <typename T, typename S, typename Fields> constexpr auto _subFields(S T::*outer, const Fields& fields) {
+    return std::apply(
+        [outer](const auto&... f) { return std::make_tuple(_subField(f.key, outer, f.member)...); }, fields);
+};
+
+// FNV-1a, seeded
+constexpr uint32_t _fieldHash(std::string_view key, uint32_t seed) {
+
+    uint32_t hash = 2166136261u ^ seed;
+    for (char c : key) { hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u; };
+
+    return hash;
+};
+
+// perfect hash of N keys. Searches for a seed that maps every key to its own slot
+template <size_t N> struct _perfectHash {
+
+    static_assert(N > 0 && N < 255, "field tables hold 1 to 254 fields");
+
+    static constexpr uint8_t empty = 0xFF;
+
+    // four slots per key (rounded to a power of two) keep the seed search short
+    static constexpr size_t slots = [] {
+        size_t n = 1;
+        while (n < N * 4) { n *= 2; };
+        return n;
+    }();
+
+    constexpr explicit _perfectHash(const std::array<std::string_view, N>& keys) {
+
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (keys[i] == keys[j]) { throw std::logic_error("duplicate key in field table"); };
+            };
+        };
+
+        for (seed = 0; seed < (1u << 16); seed++) {
+            if (_place(keys)) { return; };
+        };
+        throw std::logic_error("no perfect hash found for field table");
+    };
+
+    // index of key in keys or N if it isn't one of them
+    constexpr size_t find(std::string_view key, const std::array<std::string_view, N>& keys) const {
+
+        const uint8_t idx = index[_fieldHash(key, seed) & (slots - 1)];
+        return (idx != empty && keys[idx] == key) ? idx : N;
+    };
+
+    uint32_t seed = 0;
+    std::array<uint8_t, slots> index {};
+
+  private:
+    constexpr bool _place(const std::array<std::string_view, N>& keys) {
+
+        for (auto& i : index) { i = empty; };
+        for (size_t i = 0; i < N; i++) {
+
+            uint8_t& slot = index[_fieldHash(keys[i], seed) & (slots - 1)];
+            if (slot != empty) { return false; };
+            slot = static_cast<uint8_t>(i);
+        };
+
+        return true;
+    };
+};
+
+// looks up fields of T by key
+template <typename T> struct _fieldTable {
+
+    using fields = std::remove_const_t<decltype(T::_fields)>;
+
+    static constexpr size_t size = std::tuple_size<fields>::value;
+
+    static constexpr std::array<std::string_view, size> keys =
+        std::apply([](const auto&... f) { return std::array<std::string_view, size> { f.key... }; }, T::_fields);
+
+    static constexpr _perfectHash<size> hash { keys };
+
+    // index of the field with key or `size` if T has no such field
+    static constexpr size_t find(std::string_view key) { return hash.find(key, keys); };
+};
+
+// bit of a field in the mask returned by rju::_parseObject()
+template <typename T> constexpr uint64_t _fieldBit(std::string_view key) {
+
+    const size_t idx = _fieldTable<T>::find(key);
+    if (idx == _fieldTable<T>::size) { throw std::logic_error("no such field"); };
+
+    return uint64_t(1) << idx;
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,400 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "kite.hpp"
+#include "kiteppexceptions.hpp"
+#include "responses.hpp"
+#include "utils.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// progress of a `historicalDownloader` run
+struct historicalProgress {
+
+    size_t completedWindows = 0;
+    size_t failedWindows = 0;
+    size_t totalWindows = 0;
+    size_t completedInstruments = 0;
+    size_t totalInstruments = 0;
+};
+
+/// a window that couldn't be downloaded
+struct historicalFailure {
+
+    int instrumentToken = 0;
+    string from;
+    string to;
+    std::exception_ptr error;
+};
+
+/**
+ * @brief Downloads historical data of many instruments over ranges longer than a single request allows.
+ *
+ * The date range is split into windows no longer than the API allows for the interval. Windows are fetched by a pool
+ * of worker threads under the historical API rate limit and the candles of every instrument are merged (and
+ * deduplicated at window edges) once all of its windows are in.
+ *
+ * A failed window doesn't stop the others. Calling `run()` again only fetches the windows that haven't been downloaded
+ * yet, so a run that failed or was cancelled can be resumed. Callbacks are called from worker threads, one at a time.
+ *
+ * @attention the `kite` object must outlive the downloader. Requests made through one `kite` object share its HTTP
+ * client, so parallel requests may be serialized on the connection.
+ */
+class historicalDownloader {
+
+  public:
+    // member variables
+
+    // callbacks
+
+    /**
+     * @brief Called after every window is processed.
+     */
+    std::function<void(historicalDownloader* downloader, const historicalProgress& progress)> onProgress;
+
+    /**
+     * @brief Called when all windows of an instrument have been downloaded, with its merged candles.
+     */
+    std::function<void(historicalDownloader* downloader, int instrumentTok, const std::vector<historicalData>& candles)>
+        onInstrument;
+
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new historicalDownloader object
+     *
+     * @param Kite kite object used for sending requests
+     * @param instrumentToks
+     * @param from `yyyy-mm-dd` or `yyyy-mm-dd hh:mm:ss` formatted date
+     * @param to `yyyy-mm-dd` or `yyyy-mm-dd hh:mm:ss` formatted date
+     * @param interval candle interval (minute, day, 5minute, etc.)
+     * @param continuous whether to get continuous data
+     * @param oi whether to get OI data
+     */
+    historicalDownloader(kite& Kite, const std::vector<int>& instrumentToks, const string& from, const string& to,
+        const string& interval, bool continuous = false, bool oi = false)
+        : _kite(Kite), _interval(interval), _continuous(continuous), _oi(oi) {
+
+        int32_t fromDays = 0;
+        int32_t toDays = 0;
+        if (!kc::_parseDate(from, fromDays) || !kc::_parseDate(to, toDays)) {
+            throw libException(FMT("Invalid date range {0} - {1} (historicalDownloader)", from, to));
+        };
+        if (toDays < fromDays) { throw libException("`to` is before `from` (historicalDownloader)"); };
+
+        // split range into windows of at most maxDays days. Windows of a day start at 00:00:00 and end at 23:59:59
+        const int32_t maxDays = getMaxDays(interval);
+        std::vector<std::pair<string, string>> windows;
+        for (int32_t start = fromDays; start <= toDays; start += maxDays) {
+
+            const int32_t end = std::min(toDays, start + maxDays - 1);
+            windows.emplace_back((start == fromDays) ? from : kc::_formatDate(start) + " 00:00:00",
+                (end == toDays) ? to : kc::_formatDate(end) + " 23:59:59");
+        };
+
+        _instruments.reserve(instrumentToks.size());
+        for (int tok : instrumentToks) {
+
+            _instrument& inst = _instruments.emplace_back();
+            inst.token = tok;
+            inst.windows.resize(windows.size());
+            for (size_t i = 0; i < windows.size(); i++) {
+                inst.windows[i].from = windows[i].first;
+                inst.windows[i].to = windows[i].second;
+            };
+        };
+
+        _progress.totalInstruments = _instruments.size();
+        _progress.totalWindows = _instruments.size() * windows.size();
+    };
+
+    // methods
+
+    /**
+     * @brief Get the maximum number of days a single historical data request can span for an interval
+     *
+     * @param interval
+     *
+     * @return int
+     */
+    static int getMaxDays(const string& interval) {
+
+        static const std::unordered_map<string, int> maxDays = {
+
+            { "minute", 60 },
+            { "3minute", 100 },
+            { "5minute", 100 },
+            { "10minute", 100 },
+            { "15minute", 200 },
+            { "30minute", 200 },
+            { "60minute", 400 },
+            { "day", 2000 },
+        };
+
+        auto it = maxDays.find(interval);
+        if (it == maxDays.end()) { throw libException(FMT("Unknown interval {0} (historicalDownloader)", interval)); };
+
+        return it->second;
+    };
+
+    /**
+     * @brief Set number of worker threads used by `run()`
+     *
+     * @param workers
+     */
+    void setWorkers(size_t workers) { _workers = std::max<size_t>(workers, 1); };
+
+    /**
+     * @brief Set maximum number of requests sent per second
+     *
+     * @param requestsPerSecond
+     */
+    void setRateLimit(double requestsPerSecond) {
+        if (requestsPerSecond <= 0) { throw libException("Rate limit must be positive (historicalDownloader)"); };
+        _interRequestDelay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / requestsPerSecond));
+    };
+
+    /**
+     * @brief Download all windows that haven't been downloaded yet. Blocks until they are processed or the download is
+     * cancelled.
+     *
+     * @return true if data of all instruments has been downloaded
+     */
+    bool run() {
+
+        _cancelled = false;
+        _next = 0;
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _failures.clear();
+            _progress.failedWindows = 0;
+        };
+
+        std::vector<std::thread> threads;
+        const size_t workers = std::min(_workers, std::max<size_t>(_progress.totalWindows, 1));
+        threads.reserve(workers);
+        for (size_t i = 0; i < workers; i++) { threads.emplace_back(&historicalDownloader::_work, this); };
+        for (auto& thread : threads) { thread.join(); };
+
+        return isComplete();
+    };
+
+    /**
+     * @brief Stop a running download. Requests in flight are completed and the rest are skipped, so that `run()` can
+     * resume them later.
+     *
+     */
+    void cancel() { _cancelled = true; };
+
+    /**
+     * @brief whether data of all instruments has been downloaded
+     *
+     */
+    bool isComplete() const {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _progress.completedInstruments == _progress.totalInstruments;
+    };
+
+    /**
+     * @brief Get progress of the download
+     *
+     * @return historicalProgress
+     */
+    historicalProgress getProgress() const {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _progress;
+    };
+
+    /**
+     * @brief Get windows that failed during the last `run()`
+     *
+     * @return std::vector<historicalFailure>
+     */
+    std::vector<historicalFailure> getFailures() const {
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _failures;
+    };
+
+    /**
+     * @brief Get merged candles of an instrument
+     *
+     * @param instrumentTok
+     *
+     * @return std::vector<historicalData>
+     */
+    std::vector<historicalData> getCandles(int instrumentTok) const {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto it = _candles.find(instrumentTok);
+        if (it == _candles.end()) {
+            throw libException(FMT("Data of {0} hasn't been downloaded (historicalDownloader)", instrumentTok));
+        };
+
+        return it->second;
+    };
+
+  private:
+    struct _window {
+
+        string from;
+        string to;
+        bool done = false;
+        std::vector<historicalData> candles;
+    };
+
+    struct _instrument {
+
+        int token = 0;
+        std::vector<_window> windows;
+    };
+
+    // member variables
+
+    kite& _kite;
+    const string _interval;
+    const bool _continuous = false;
+    const bool _oi = false;
+
+    size_t _workers = 3;
+    std::chrono::steady_clock::duration _interRequestDelay = std::chrono::milliseconds(334); // 3 requests per second
+
+    std::vector<_instrument> _instruments;
+    std::atomic<bool> _cancelled { false };
+    std::atomic<size_t> _next { 0 }; // next window to be picked up, flattened across instruments
+
+    mutable std::mutex _mtx;
+    historicalProgress _progress;
+    std::vector<historicalFailure> _failures;
+    std::unordered_map<int, std::vector<historicalData>> _candles;
+
+    std::mutex _rateMtx;
+    std::chrono::steady_clock::time_point _nextSlot;
+
+    std::mutex _callbackMtx;
+
+    // methods
+
+    void _work() {
+
+        const size_t windowsPerInst = (_instruments.empty()) ? 0 : _instruments.front().windows.size();
+        while (!_cancelled) {
+
+            const size_t job = _next++;
+            if (job >= _progress.totalWindows) { return; };
+
+            _instrument& inst = _instruments[job / windowsPerInst];
+            _window& window = inst.windows[job % windowsPerInst];
+            if (window.done) { continue; };
+
+            _waitForSlot();
+            if (_cancelled) { return; };
+
+            std::exception_ptr error;
+            std::vector<historicalData> candles;
+            try {
+                candles = _kite.getHistoricalData(inst.token, window.from, window.to, _interval, _continuous, _oi);
+            } catch (...) { error = std::current_exception(); };
+
+            _finishWindow(inst, window, std::move(candles), error);
+        };
+    };
+
+    // blocks until the next request is allowed by the rate limit
+    void _waitForSlot() {
+
+        std::chrono::steady_clock::time_point slot;
+        {
+            std::lock_guard<std::mutex> lock(_rateMtx);
+            slot = std::max(std::chrono::steady_clock::now(), _nextSlot);
+            _nextSlot = slot + _interRequestDelay;
+        };
+        std::this_thread::sleep_until(slot);
+    };
+
+    void _finishWindow(
+        _instrument& inst, _window& window, std::vector<historicalData>&& candles, const std::exception_ptr& error) {
+
+        const std::vector<historicalData>* merged = nullptr;
+        historicalProgress progress;
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            if (error) {
+
+                _failures.push_back({ inst.token, window.from, window.to, error });
+                _progress.failedWindows++;
+            } else {
+
+                window.candles = std::move(candles);
+                window.done = true;
+                _progress.completedWindows++;
+                if (std::all_of(inst.windows.begin(), inst.windows.end(), [](const _window& w) { return w.done; })) {
+                    // candles of a completed instrument aren't modified anymore, so they can be read without the lock
+                    merged = &(_candles[inst.token] = _merge(inst));
+                    _progress.completedInstruments++;
+                };
+            };
+            progress = _progress;
+        };
+
+        std::lock_guard<std::mutex> lock(_callbackMtx);
+        if (merged != nullptr && onInstrument) { onInstrument(this, inst.token, *merged); };
+        if (onProgress) { onProgress(this, progress); };
+    };
+
+    // concatenates windows of an instrument, dropping candles repeated at window edges. Windows are in order and ISO
+    // 8601 timestamps with the same offset compare the same way as strings
+    static std::vector<historicalData> _merge(_instrument& inst) {
+
+        size_t total = 0;
+        for (const auto& window : inst.windows) { total += window.candles.size(); };
+
+        std::vector<historicalData> merged;
+        merged.reserve(total);
+        for (auto& window : inst.windows) {
+
+            for (auto& candle : window.candles) {
+                if (!merged.empty() && candle.datetime <= merged.back().datetime) { continue; };
+                merged.emplace_back(std::move(candle));
+            };
+            window.candles.clear();
+            window.candles.shrink_to_fit();
+        };
+
+        return merged;
+    };
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,510 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "config.hpp"
+#include "kite.hpp"
+#include "kiteppexceptions.hpp"
+#include "responses.hpp"
+#include "utils.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// instrumentView is a non-owning view of an instrument stored in an `instrumentFile`. Strings point into the file.
+struct instrumentView {
+
+    /// copy the view into an owning `instrument`
+    instrument toInstrument() const {
+
+        instrument inst;
+        inst.instrumentToken = instrumentToken;
+        inst.exchangeToken = exchangeToken;
+        inst.tradingsymbol = string(tradingsymbol);
+        inst.name = string(name);
+        inst.lastPrice = lastPrice;
+        inst.expiry = string(expiry);
+        inst.strikePrice = strikePrice;
+        inst.tickSize = tickSize;
+        inst.lotSize = lotSize;
+        inst.instrumentType = string(instrumentType);
+        inst.segment = string(segment);
+        inst.exchange = string(exchange);
+
+        return inst;
+    };
+
+    int instrumentToken = 0;
+    int exchangeToken = 0;
+    std::string_view tradingsymbol;
+    std::string_view name;
+    double lastPrice = 0.0;
+    std::string_view expiry;
+    double strikePrice = 0.0;
+    double tickSize = 0.0;
+    double lotSize = 0.0;
+    std::string_view instrumentType;
+    std::string_view segment;
+    std::string_view exchange;
+};
+
+/**
+ * @brief Read-only, memory-mapped instrument master stored in kitepp's binary format.
+ *
+ * The file consists of a fixed header, an array of fixed size records and a table of deduplicated strings referred to
+ * by the records. Opening a file only maps it, so instruments are available without parsing anything. Files are
+ * written in native byte order and are rejected on a machine with a different one.
+ */
+class instrumentFile {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Map an instrument file
+     *
+     * @param path
+     *
+     * @throws libException if the file can't be mapped or isn't a valid instrument file
+     */
+    explicit instrumentFile(const string& path) {
+
+        _map(path);
+
+        if (_size < sizeof(_header)) {
+            _unmap();
+            throw libException(FMT("{0} is too small to be an instrument file", path));
+        };
+
+        std::memcpy(&_hdr, _data, sizeof(_header));
+        if (std::memcmp(_hdr.magic, _magic, sizeof(_hdr.magic)) != 0 || _hdr.version != _version ||
+            _hdr.byteOrder != _byteOrder || _hdr.recordSize != sizeof(_record) ||
+            // written as differences so that corrupt offsets and sizes can't wrap around
+            _hdr.recordsOffset > _hdr.stringsOffset ||
+            _hdr.count > (_hdr.stringsOffset - _hdr.recordsOffset) / sizeof(_record) || _hdr.stringsOffset > _size ||
+            _hdr.stringsSize > _size - _hdr.stringsOffset) {
+            _unmap();
+            throw libException(FMT("{0} isn't a valid instrument file", path));
+        };
+
+        _records = reinterpret_cast<const _record*>(_data + _hdr.recordsOffset);
+        _strings = reinterpret_cast<const char*>(_data + _hdr.stringsOffset);
+    };
+
+    instrumentFile(const instrumentFile&) = delete;
+    instrumentFile& operator=(const instrumentFile&) = delete;
+
+    ~instrumentFile() { _unmap(); };
+
+    // methods
+
+    /**
+     * @brief number of instruments in the file
+     *
+     * @return size_t
+     */
+    size_t size() const { return _hdr.count; };
+
+    /**
+     * @brief trading day the file was written for, as yyyymmdd
+     *
+     * @return uint32_t
+     */
+    uint32_t tradingDay() const { return _hdr.tradingDay; };
+
+    /**
+     * @brief get instrument at idx. Returned view is valid as long as this object is alive.
+     *
+     * @param idx
+     * @return instrumentView
+     */
+    instrumentView operator[](size_t idx) const {
+
+        const _record& rec = _records[idx];
+        instrumentView view;
+
+        view.instrumentToken = rec.instrumentToken;
+        view.exchangeToken = rec.exchangeToken;
+        view.tradingsymbol = _str(rec.tradingsymbol);
+        view.name = _str(rec.name);
+        view.lastPrice = rec.lastPrice;
+        view.expiry = _str(rec.expiry);
+        view.strikePrice = rec.strikePrice;
+        view.tickSize = rec.tickSize;
+        view.lotSize = rec.lotSize;
+        view.instrumentType = _str(rec.instrumentType);
+        view.segment = _str(rec.segment);
+        view.exchange = _str(rec.exchange);
+
+        return view;
+    };
+
+    /**
+     * @brief copy all instruments into a vector
+     *
+     * @return std::vector<instrument>
+     */
+    std::vector<instrument> toVector() const {
+
+        std::vector<instrument> instruments;
+        instruments.reserve(size());
+        for (size_t i = 0; i < size(); i++) { instruments.emplace_back((*this)[i].toInstrument()); };
+
+        return instruments;
+    };
+
+    /**
+     * @brief Write instruments to path. The file is written to a temporary file first and then renamed over path, so
+     * readers either see the old file or the new one but never a partially written one.
+     *
+     * @param path
+     * @param instruments
+     * @param tradingDay trading day as yyyymmdd
+     *
+     * @throws libException if the file couldn't be written
+     */
+    static void write(const string& path, const std::vector<instrument>& instruments, uint32_t tradingDay) {
+
+        string strings;
+        std::unordered_map<string, _strRef> stringRefs;
+        const auto addString = [&](const string& str) -> _strRef {
+            auto it = stringRefs.find(str);
+            if (it != stringRefs.end()) { return it->second; };
+
+            _strRef ref { static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(str.size()) };
+            strings.append(str);
+            stringRefs.emplace(str, ref);
+            return ref;
+        };
+
+        std::vector<_record> records;
+        records.reserve(instruments.size());
+        for (const auto& inst : instruments) {
+
+            _record rec {};
+            rec.instrumentToken = inst.instrumentToken;
+            rec.exchangeToken = inst.exchangeToken;
+            rec.lastPrice = inst.lastPrice;
+            rec.strikePrice = inst.strikePrice;
+            rec.tickSize = inst.tickSize;
+            rec.lotSize = inst.lotSize;
+            rec.tradingsymbol = addString(inst.tradingsymbol);
+            rec.name = addString(inst.name);
+            rec.expiry = addString(inst.expiry);
+            rec.instrumentType = addString(inst.instrumentType);
+            rec.segment = addString(inst.segment);
+            rec.exchange = addString(inst.exchange);
+            records.emplace_back(rec);
+        };
+
+        _header hdr {};
+        std::memcpy(hdr.magic, _magic, sizeof(hdr.magic));
+        hdr.version = _version;
+        hdr.byteOrder = _byteOrder;
+        hdr.tradingDay = tradingDay;
+        hdr.recordSize = sizeof(_record);
+        hdr.count = records.size();
+        hdr.recordsOffset = sizeof(_header);
+        hdr.stringsOffset = hdr.recordsOffset + records.size() * sizeof(_record);
+        hdr.stringsSize = strings.size();
+
+        const string tmpPath = FMT("{0}.tmp.{1}", path, _pid());
+        std::FILE* file = std::fopen(tmpPath.c_str(), "wb");
+        if (file == nullptr) { throw libException(FMT("Failed to open {0} for writing", tmpPath)); };
+
+        bool ok = std::fwrite(&hdr, sizeof(hdr), 1, file) == 1;
+        if (ok && !records.empty()) {
+            ok = std::fwrite(records.data(), sizeof(_record), records.size(), file) == records.size();
+        };
+        if (ok && !strings.empty()) { ok = std::fwrite(strings.data(), 1, strings.size(), file) == strings.size(); };
+        ok = (std::fflush(file) == 0) && ok;
+#ifndef _WIN32
+        ok = (::fsync(::fileno(file)) == 0) && ok;
+#endif
+        ok = (std::fclose(file) == 0) && ok;
+
+#ifdef _WIN32
+        // rename() doesn't replace existing files on windows
+        if (ok) { std::remove(path.c_str()); };
+#endif
+        if (!ok || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            std::remove(tmpPath.c_str());
+            throw libException(FMT("Failed to write instrument file {0}", path));
+        };
+    };
+
+  private:
+    struct _strRef {
+
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    struct _header {
+
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t tradingDay;
+        uint32_t recordSize;
+        uint64_t count;
+        uint64_t recordsOffset;
+        uint64_t stringsOffset;
+        uint64_t stringsSize;
+    };
+
+    struct _record {
+
+        int32_t instrumentToken;
+        int32_t exchangeToken;
+        double lastPrice;
+        double strikePrice;
+        double tickSize;
+        double lotSize;
+        _strRef tradingsymbol;
+        _strRef name;
+        _strRef expiry;
+        _strRef instrumentType;
+        _strRef segment;
+        _strRef exchange;
+    };
+
+    static_assert(sizeof(_header) == 56, "unexpected padding in instrument file header");
+    static_assert(sizeof(_record) == 88, "unexpected padding in instrument file record");
+
+    static constexpr char _magic[8] = { 'K', 'P', 'P', 'I', 'N', 'S', 'T', '\0' };
+    static constexpr uint32_t _version = 1;
+    static constexpr uint32_t _byteOrder = 0x01020304;
+
+    // member variables
+
+    const unsigned char* _data = nullptr;
+    size_t _size = 0;
+    _header _hdr {};
+    const _record* _records = nullptr;
+    const char* _strings = nullptr;
+#ifdef _WIN32
+    std::vector<unsigned char> _buffer;
+#endif
+
+    // methods
+
+    std::string_view _str(const _strRef& ref) const {
+        return (ref.offset + static_cast<uint64_t>(ref.length) <= _hdr.stringsSize) ?
+                   std::string_view(_strings + ref.offset, ref.length) :
+                   std::string_view();
+    };
+
+#ifdef _WIN32
+    // no mmap on windows, read the whole file instead
+    void _map(const string& path) {
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file) { throw libException(FMT("Failed to open {0}", path)); };
+        _buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        _data = _buffer.data();
+        _size = _buffer.size();
+    };
+
+    void _unmap() {
+        _buffer.clear();
+        _data = nullptr;
+        _size = 0;
+    };
+
+    static unsigned long _pid() { return 0; };
+#else
+    void _map(const string& path) {
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) { throw libException(FMT("Failed to open {0}", path)); };
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            throw libException(FMT("Failed to stat {0}", path));
+        };
+
+        void* addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        // mapping stays valid after closing the descriptor
+        ::close(fd);
+        if (addr == MAP_FAILED) { throw libException(FMT("Failed to map {0}", path)); };
+
+        _data = static_cast<const unsigned char*>(addr);
+        _size = static_cast<size_t>(st.st_size);
+    };
+
+    void _unmap() {
+        if (_data != nullptr) { ::munmap(const_cast<unsigned char*>(_data), _size); };
+        _data = nullptr;
+        _size = 0;
+    };
+
+    static unsigned long _pid() { return static_cast<unsigned long>(::getpid()); };
+#endif
+};
+
+/**
+ * @brief On-disk cache of the instrument master.
+ *
+ * Instruments of every exchange are stored in `directory` as an `instrumentFile` tagged with the trading day they were
+ * downloaded for. The instrument master is downloaded only when the stored file is missing or belongs to an older
+ * trading day, so every start after the first one of the day maps the file instead of touching the network. A new
+ * trading day starts at `refreshTime` IST, after Kite regenerates the instrument dump.
+ */
+class instrumentCache {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new instrumentCache object
+     *
+     * @param Kite kite object used for downloading instruments
+     * @param directory directory in which instrument files are stored. Must exist.
+     * @param refreshTime time (IST, since midnight) after which instruments of the previous day are considered stale
+     */
+    instrumentCache(kite& Kite, string directory,
+        std::chrono::minutes refreshTime = std::chrono::hours(8) + std::chrono::minutes(30))
+        : _kite(Kite), _directory(std::move(directory)), _refreshTime(refreshTime) {};
+
+    // methods
+
+    /**
+     * @brief Get instruments of an exchange, downloading them only if the cached copy is stale.
+     *
+     * @param exchange instruments of all exchanges are returned if none specified
+     *
+     * @return std::shared_ptr<const instrumentFile>
+     */
+    std::shared_ptr<const instrumentFile> load(const string& exchange = "") {
+
+        const uint32_t today = currentTradingDay();
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto& file = _files[exchange];
+        if (file && file->tradingDay() == today) { return file; };
+
+        const string path = getPath(exchange);
+        try {
+
+            auto onDisk = std::make_shared<const instrumentFile>(path);
+            if (onDisk->tradingDay() == today) {
+                file = std::move(onDisk);
+                return file;
+            };
+        } catch (const libException&) {
+            // missing or corrupt. download again
+        };
+
+        instrumentFile::write(path, _kite.getInstruments(exchange), today);
+        file = std::make_shared<const instrumentFile>(path);
+
+        return file;
+    };
+
+    /**
+     * @brief Download instruments of an exchange again, irrespective of the cached copy
+     *
+     * @param exchange
+     *
+     * @return std::shared_ptr<const instrumentFile>
+     */
+    std::shared_ptr<const instrumentFile> refresh(const string& exchange = "") {
+
+        const uint32_t today = currentTradingDay();
+        const string path = getPath(exchange);
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        instrumentFile::write(path, _kite.getInstruments(exchange), today);
+        auto& file = _files[exchange];
+        file = std::make_shared<const instrumentFile>(path);
+
+        return file;
+    };
+
+    /**
+     * @brief Same as `kite::getInstruments()` but served from the cache
+     *
+     * @param exchange returns all instruments if none specified
+     *
+     * @return std::vector<instrument>
+     */
+    std::vector<instrument> getInstruments(const string& exchange = "") { return load(exchange)->toVector(); };
+
+    /**
+     * @brief Get path of the file instruments of an exchange are stored at
+     *
+     * @param exchange
+     *
+     * @return string
+     */
+    string getPath(const string& exchange = "") const {
+        return FMT("{0}/instruments_{1}.bin", _directory, (exchange.empty()) ? "all" : exchange);
+    };
+
+    /**
+     * @brief Get the current trading day as yyyymmdd
+     *
+     * @return uint32_t
+     */
+    uint32_t currentTradingDay() const {
+
+        static constexpr int64_t ISTOffset = 5 * 3600 + 30 * 60;
+        const int64_t now =
+            std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch())
+                .count();
+        const int64_t shifted = now + ISTOffset - std::chrono::duration_cast<std::chrono::seconds>(_refreshTime).count();
+        const int64_t days = (shifted >= 0) ? shifted / 86400 : (shifted - 86399) / 86400;
+
+        return kc::_civilFromDays(static_cast<int32_t>(days));
+    };
+
+  private:
+    // member variables
+
+    kite& _kite;
+    const string _directory;
+    const std::chrono::minutes _refreshTime;
+    std::mutex _mtx;
+    std::unordered_map<string, std::shared_ptr<const instrumentFile>> _files;
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,448 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "instrumentcache.hpp"
+#include "kiteppexceptions.hpp"
+#include "responses.hpp"
+#include "utils.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/**
+ * @brief Indexed, column-wise store of instruments.
+ *
+ * Every field of `instrument` is kept in its own column. Low-cardinality strings (`exchange`, `segment`,
+ * `instrumentType`, `name` and `expiry`) are interned and stored as ids. Instruments can be looked up in O(1) by
+ * instrument token and by `exchange:tradingsymbol` through open-addressing hash indexes, and a sorted index on (name,
+ * expiry, strike, instrument type) allows range queries such as "all NIFTY options expiring on a given day".
+ *
+ * A store is immutable once built, so it can be read from any number of threads.
+ */
+class instrumentStore {
+
+  public:
+    /// returned by lookups when an instrument isn't found
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    /// value of `expiryDays()` for instruments without an expiry
+    static constexpr int32_t noExpiry = std::numeric_limits<int32_t>::min();
+
+    // constructors and destructor
+
+    instrumentStore() = default;
+
+    /**
+     * @brief Construct a new instrumentStore object
+     *
+     * @param instruments instruments returned by `kite::getInstruments()`
+     */
+    explicit instrumentStore(const std::vector<instrument>& instruments) {
+        _build(instruments.size(), [&instruments](size_t i) -> const instrument& { return instruments[i]; });
+    };
+
+    /**
+     * @brief Construct a new instrumentStore object
+     *
+     * @param file instrument file loaded by `instrumentCache`
+     */
+    explicit instrumentStore(const instrumentFile& file) {
+        _build(file.size(), [&file](size_t i) { return file[i]; });
+    };
+
+    // methods
+
+    /**
+     * @brief number of instruments in the store
+     *
+     * @return size_t
+     */
+    size_t size() const { return _instrumentTokens.size(); };
+
+    /**
+     * @brief Find an instrument by its instrument token
+     *
+     * @param instrumentToken
+     *
+     * @return size_t index of the instrument or `npos`
+     */
+    size_t findByToken(int instrumentToken) const {
+
+        return _tokenIndex.find(_hashToken(instrumentToken),
+            [this, instrumentToken](uint32_t idx) { return _instrumentTokens[idx] == instrumentToken; });
+    };
+
+    /**
+     * @brief Find an instrument by exchange and trading symbol
+     *
+     * @param exchange
+     * @param tradingsymbol
+     *
+     * @return size_t index of the instrument or `npos`
+     */
+    size_t findBySymbol(std::string_view exchange, std::string_view tradingsymbol) const {
+
+        return _symbolIndex.find(_hashSymbol(exchange, tradingsymbol), [&](uint32_t idx) {
+            return this->tradingsymbol(idx) == tradingsymbol && this->exchange(idx) == exchange;
+        });
+    };
+
+    /**
+     * @brief Find an instrument by trading symbol in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @param symbol
+     *
+     * @return size_t index of the instrument or `npos`
+     */
+    size_t findBySymbol(std::string_view symbol) const {
+
+        const size_t sep = symbol.find(':');
+        if (sep == std::string_view::npos) { return npos; };
+
+        return findBySymbol(symbol.substr(0, sep), symbol.substr(sep + 1));
+    };
+
+    /**
+     * @brief Get indexes of instruments with a name, ordered by expiry, strike and instrument type
+     *
+     * @param name
+     *
+     * @return std::pair<const uint32_t*, const uint32_t*> range of indexes
+     */
+    std::pair<const uint32_t*, const uint32_t*> findByName(std::string_view name) const {
+
+        const uint32_t nameID = _names.find(name);
+        if (nameID == _internTable::npos) { return { nullptr, nullptr }; };
+
+        auto range =
+            std::equal_range(_sortedIndex.begin(), _sortedIndex.end(), _nameKey { nameID }, _nameOrder { this });
+
+        return { _sortedIndex.data() + (range.first - _sortedIndex.begin()),
+            _sortedIndex.data() + (range.second - _sortedIndex.begin()) };
+    };
+
+    /**
+     * @brief Get indexes of instruments with a name and an expiry, ordered by strike and instrument type
+     *
+     * @param name
+     * @param expiryDays expiry as days since 1970-01-01
+     *
+     * @return std::pair<const uint32_t*, const uint32_t*> range of indexes
+     */
+    std::pair<const uint32_t*, const uint32_t*> findByName(std::string_view name, int32_t expiryDays) const {
+
+        auto range = findByName(name);
+        auto begin = std::lower_bound(range.first, range.second, expiryDays,
+            [this](uint32_t idx, int32_t expiry) { return _expiryDays[idx] < expiry; });
+        auto end = std::upper_bound(begin, range.second, expiryDays,
+            [this](int32_t expiry, uint32_t idx) { return expiry < _expiryDays[idx]; });
+
+        return { begin, end };
+    };
+
+    /**
+     * @brief indexes of all instruments ordered by name, expiry, strike and instrument type
+     *
+     * @return const std::vector<uint32_t>&
+     */
+    const std::vector<uint32_t>& sortedIndex() const { return _sortedIndex; };
+
+    /**
+     * @brief copy instrument at idx into an `instrument`
+     *
+     * @param idx
+     *
+     * @return instrument
+     */
+    instrument get(size_t idx) const {
+
+        instrument inst;
+        inst.instrumentToken = _instrumentTokens[idx];
+        inst.exchangeToken = _exchangeTokens[idx];
+        inst.tradingsymbol = string(tradingsymbol(idx));
+        inst.name = string(name(idx));
+        inst.lastPrice = _lastPrices[idx];
+        inst.expiry = string(expiry(idx));
+        inst.strikePrice = _strikePrices[idx];
+        inst.tickSize = _tickSizes[idx];
+        inst.lotSize = _lotSizes[idx];
+        inst.instrumentType = string(instrumentType(idx));
+        inst.segment = string(segment(idx));
+        inst.exchange = string(exchange(idx));
+
+        return inst;
+    };
+
+    // columns
+
+    int instrumentToken(size_t idx) const { return _instrumentTokens[idx]; };
+    int exchangeToken(size_t idx) const { return _exchangeTokens[idx]; };
+    std::string_view tradingsymbol(size_t idx) const {
+        return std::string_view(_symbols).substr(_symbolOffsets[idx], _symbolOffsets[idx + 1] - _symbolOffsets[idx]);
+    };
+    std::string_view name(size_t idx) const { return _names[_nameIDs[idx]]; };
+    double lastPrice(size_t idx) const { return _lastPrices[idx]; };
+    std::string_view expiry(size_t idx) const { return _expiries[_expiryIDs[idx]]; };
+    /// expiry as days since 1970-01-01 or `noExpiry`
+    int32_t expiryDays(size_t idx) const { return _expiryDays[idx]; };
+    double strikePrice(size_t idx) const { return _strikePrices[idx]; };
+    double tickSize(size_t idx) const { return _tickSizes[idx]; };
+    double lotSize(size_t idx) const { return _lotSizes[idx]; };
+    std::string_view instrumentType(size_t idx) const { return _instrumentTypes[_instrumentTypeIDs[idx]]; };
+    std::string_view segment(size_t idx) const { return _segments[_segmentIDs[idx]]; };
+    std::string_view exchange(size_t idx) const { return _exchanges[_exchangeIDs[idx]]; };
+
+    /// contiguous column of instrument tokens, in store order
+    const std::vector<int32_t>& instrumentTokens() const { return _instrumentTokens; };
+    /// contiguous column of strike prices, in store order
+    const std::vector<double>& strikePrices() const { return _strikePrices; };
+
+  private:
+    // stores every distinct string once and hands out dense ids
+    class _internTable {
+
+      public:
+        static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+        _internTable() = default;
+
+        // _ids refers to the strings of the table it belongs to, rebuild it on copies
+        _internTable(const _internTable& other): _strings(other._strings) { _reindex(); };
+        _internTable& operator=(const _internTable& other) {
+            _strings = other._strings;
+            _reindex();
+            return *this;
+        };
+        _internTable(_internTable&&) = default;
+        _internTable& operator=(_internTable&&) = default;
+
+        uint32_t intern(std::string_view str) {
+
+            auto it = _ids.find(str);
+            if (it != _ids.end()) { return it->second; };
+
+            const string& stored = _strings.emplace_back(str);
+            const uint32_t id = static_cast<uint32_t>(_strings.size() - 1);
+            _ids.emplace(stored, id);
+
+            return id;
+        };
+
+        uint32_t find(std::string_view str) const {
+
+            auto it = _ids.find(str);
+            return (it == _ids.end()) ? npos : it->second;
+        };
+
+        std::string_view operator[](uint32_t id) const { return _strings[id]; };
+
+      private:
+        std::deque<string> _strings; // references are stable on push_back
+        std::unordered_map<std::string_view, uint32_t> _ids;
+
+        void _reindex() {
+
+            _ids.clear();
+            for (size_t i = 0; i < _strings.size(); i++) { _ids.emplace(_strings[i], static_cast<uint32_t>(i)); };
+        };
+    };
+
+    // open-addressing hash index with linear probing. Slots hold instrument index + 1 (0 being empty), keys are
+    // compared by looking up the columns
+    class _flatIndex {
+
+      public:
+        void reserve(size_t n) {
+
+            size_t capacity = 16;
+            while (capacity < n * 2) { capacity <<= 1; };
+            _slots.assign(capacity, 0);
+            _mask = capacity - 1;
+        };
+
+        // returns false if an equal key already exists
+        template <typename Eq> bool insert(size_t hash, uint32_t idx, Eq eq) {
+
+            for (size_t pos = hash & _mask;; pos = (pos + 1) & _mask) {
+
+                if (_slots[pos] == 0) {
+                    _slots[pos] = idx + 1;
+                    return true;
+                };
+                if (eq(_slots[pos] - 1)) { return false; };
+            };
+        };
+
+        template <typename Eq> size_t find(size_t hash, Eq eq) const {
+
+            if (_slots.empty()) { return npos; };
+
+            for (size_t pos = hash & _mask;; pos = (pos + 1) & _mask) {
+
+                if (_slots[pos] == 0) { return npos; };
+                if (eq(_slots[pos] - 1)) { return _slots[pos] - 1; };
+            };
+        };
+
+      private:
+        std::vector<uint32_t> _slots;
+        size_t _mask = 0;
+    };
+
+    struct _nameKey {
+
+        uint32_t id;
+    };
+
+    // orders indexes of _sortedIndex by name only
+    struct _nameOrder {
+
+        const instrumentStore* store;
+
+        bool operator()(uint32_t idx, _nameKey name) const { return store->_nameIDs[idx] < name.id; };
+        bool operator()(_nameKey name, uint32_t idx) const { return name.id < store->_nameIDs[idx]; };
+    };
+
+    // member variables
+
+    std::vector<int32_t> _instrumentTokens;
+    std::vector<int32_t> _exchangeTokens;
+    string _symbols;
+    std::vector<uint32_t> _symbolOffsets { 0 };
+    std::vector<uint32_t> _nameIDs;
+    std::vector<double> _lastPrices;
+    std::vector<uint32_t> _expiryIDs;
+    std::vector<int32_t> _expiryDays;
+    std::vector<double> _strikePrices;
+    std::vector<double> _tickSizes;
+    std::vector<double> _lotSizes;
+    std::vector<uint32_t> _instrumentTypeIDs;
+    std::vector<uint32_t> _segmentIDs;
+    std::vector<uint32_t> _exchangeIDs;
+
+    _internTable _names;
+    _internTable _expiries;
+    _internTable _instrumentTypes;
+    _internTable _segments;
+    _internTable _exchanges;
+
+    _flatIndex _tokenIndex;
+    _flatIndex _symbolIndex;
+    // names are ordered by their interned id, which groups them together. Rest of the keys are ordered by value
+    std::vector<uint32_t> _sortedIndex;
+
+    // methods
+
+    static size_t _hashToken(int instrumentToken) {
+
+        // tokens are sequential-ish, spread them out (splitmix64 finalizer)
+        uint64_t x = static_cast<uint32_t>(instrumentToken);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>(x ^ (x >> 31));
+    };
+
+    static size_t _hashSymbol(std::string_view exchange, std::string_view tradingsymbol) {
+
+        const size_t h = std::hash<std::string_view> {}(tradingsymbol);
+        return h ^ (std::hash<std::string_view> {}(exchange) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+    };
+
+    template <typename Get> void _build(size_t n, Get get) {
+
+        if (n >= std::numeric_limits<uint32_t>::max()) {
+            throw libException("Too many instruments (instrumentStore)");
+        };
+
+        _instrumentTokens.reserve(n);
+        _exchangeTokens.reserve(n);
+        _symbolOffsets.reserve(n + 1);
+        _nameIDs.reserve(n);
+        _lastPrices.reserve(n);
+        _expiryIDs.reserve(n);
+        _expiryDays.reserve(n);
+        _strikePrices.reserve(n);
+        _tickSizes.reserve(n);
+        _lotSizes.reserve(n);
+        _instrumentTypeIDs.reserve(n);
+        _segmentIDs.reserve(n);
+        _exchangeIDs.reserve(n);
+
+        for (size_t i = 0; i < n; i++) {
+
+            const auto& inst = get(i);
+
+            _instrumentTokens.push_back(inst.instrumentToken);
+            _exchangeTokens.push_back(inst.exchangeToken);
+            _symbols.append(inst.tradingsymbol);
+            _symbolOffsets.push_back(static_cast<uint32_t>(_symbols.size()));
+            _nameIDs.push_back(_names.intern(inst.name));
+            _lastPrices.push_back(inst.lastPrice);
+            _expiryIDs.push_back(_expiries.intern(inst.expiry));
+            int32_t days = noExpiry;
+            _expiryDays.push_back(kc::_parseDate(inst.expiry, days) ? days : noExpiry);
+            _strikePrices.push_back(inst.strikePrice);
+            _tickSizes.push_back(inst.tickSize);
+            _lotSizes.push_back(inst.lotSize);
+            _instrumentTypeIDs.push_back(_instrumentTypes.intern(inst.instrumentType));
+            _segmentIDs.push_back(_segments.intern(inst.segment));
+            _exchangeIDs.push_back(_exchanges.intern(inst.exchange));
+        };
+
+        // same instrument can be listed more than once when dumps of several exchanges are combined. first one wins
+        _tokenIndex.reserve(n);
+        _symbolIndex.reserve(n);
+        for (uint32_t i = 0; i < n; i++) {
+
+            const int token = _instrumentTokens[i];
+            _tokenIndex.insert(
+                _hashToken(token), i, [this, token](uint32_t idx) { return _instrumentTokens[idx] == token; });
+
+            const auto exch = exchange(i);
+            const auto symbol = tradingsymbol(i);
+            _symbolIndex.insert(_hashSymbol(exch, symbol), i, [&](uint32_t idx) {
+                return tradingsymbol(idx) == symbol && exchange(idx) == exch;
+            });
+        };
+
+        _sortedIndex.resize(n);
+        for (uint32_t i = 0; i < n; i++) { _sortedIndex[i] = i; };
+        std::sort(_sortedIndex.begin(), _sortedIndex.end(), [this](uint32_t a, uint32_t b) {
+            if (_nameIDs[a] != _nameIDs[b]) { return _nameIDs[a] < _nameIDs[b]; };
+            if (_expiryDays[a] != _expiryDays[b]) { return _expiryDays[a] < _expiryDays[b]; };
+            if (_strikePrices[a] != _strikePrices[b]) { return _strikePrices[a] < _strikePrices[b]; };
+            return instrumentType(a) < instrumentType(b);
+        });
+    };
+};
+
+} // namespace kiteconnect
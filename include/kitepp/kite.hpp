@@ -18,17 +18,25 @@
 
 #include <algorithm> //for_each
 #include <array>
-#include <cmath>    //isnan()
+#include <chrono>
+#include <cmath> //isnan()
+#include <functional>
 #include <iostream> //debug
 #include <limits>   //nan
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <utility> //pair<>
 #include <vector>
 
 #include "PicoSHA2/picosha2.h"
+// the transports use OpenSSL directly, so httplib has to be built with it
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
 #include "cpp-httplib/httplib.h"
 
 #include "rapidjson/document.h"
@@ -37,10 +45,18 @@
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 
+#include "compact.hpp"
 #include "config.hpp"
+#include "csvparser.hpp"
 #include "kiteppexceptions.hpp"
+#include "metrics.hpp"
+#include "preparedorder.hpp"
+#include "requestbuilder.hpp"
 #include "responses.hpp"
 #include "rjutils.hpp"
+#include "saxparser.hpp"
+#include "snapshots.hpp"
+#include "transport.hpp"
 #include "utils.hpp"
 
 namespace kiteconnect {
@@ -74,7 +90,7 @@ class kite {
      * @paragraph ex1 Example
      * @snippet example2.cpp initializing kite
      */
-    explicit kite(string apikey): _apiKey(std::move(apikey)), _httpClient(_rootURL.c_str()) {};
+    explicit kite(string apikey): _apiKey(std::move(apikey)), _httpTransport(_rootURL) { _updateHeaders(); };
 
     virtual ~kite() {};
 
@@ -87,7 +103,10 @@ class kite {
      *
      * @param arg
      */
-    void setAPIKey(const string& arg) { _apiKey = arg; };
+    void setAPIKey(const string& arg) {
+        _apiKey = arg;
+        _updateHeaders();
+    };
 
     /**
      * @brief get set API key
@@ -96,6 +115,46 @@ class kite {
      */
     string getAPIKey() const { return _apiKey; };
 
+    /**
+     * @brief Set the transport requests are sent through. Requests are sent with `httplib::Client` by default
+     *
+     * @param trans transport. Pass nullptr to go back to the default one
+     */
+    void setTransport(std::unique_ptr<transport> trans) { _transport = std::move(trans); };
+
+    /**
+     * @brief open the connection to the API ahead of the first request, so that the first order doesn't pay for the
+     * DNS lookup and the TCP and TLS handshakes
+     *
+     */
+    void warmup() { (_transport) ? _transport->warmup() : _httpTransport.warmup(); };
+
+    /**
+     * @brief keep the connection from being closed while it's idle by sending a request whenever it has been idle for
+     * an interval. Only applies to the default transport
+     *
+     * @param interval should be shorter than the server's keep-alive timeout. Pass 0 to stop
+     */
+    void setHeartbeat(std::chrono::milliseconds interval) {
+        (interval.count() > 0) ? _httpTransport.startHeartbeat(interval) : _httpTransport.stopHeartbeat();
+    };
+
+    /**
+     * @brief get numbers of full and resumed TLS handshakes done so far
+     *
+     * @return handshakeCounts
+     */
+    handshakeCounts getHandshakeCounts() const {
+        return (_transport) ? _transport->getHandshakeCounts() : _httpTransport.getHandshakeCounts();
+    };
+
+    /**
+     * @brief get latencies of requests sent so far, by endpoint and phase. `getMetrics().dump()` gives them as text
+     *
+     * @return restMetrics&
+     */
+    restMetrics& getMetrics() { return _metrics; };
+
     /**
      * @brief Get the remote login url to which a user should be redirected to initiate the login flow.
      *
@@ -118,8 +177,8 @@ class kite {
      */
     userSession generateSession(const string& requestToken, const string& apiSecret) {
 
-        rj::Document res;
-        _sendReq(res, _methods::POST, _endpoints.at("api.token"),
+        rju::_document res;
+        _sendReq(res, _methods::POST, _endpoint("api.token"),
             {
 
                 { "api_key", _apiKey },
@@ -144,7 +203,10 @@ class kite {
      * @paragraph ex1 Example
      * @snippet example2.cpp settting access token
      */
-    void setAccessToken(const string& arg) { _accessToken = arg; };
+    void setAccessToken(const string& arg) {
+        _accessToken = arg;
+        _updateHeaders();
+    };
 
     /**
      * @brief Get the Access Token set currently
@@ -165,9 +227,9 @@ class kite {
      */
     void invalidateSession() {
 
-        rj::Document res;
+        rju::_document res;
         _sendReq(res, _methods::DEL,
-            FMT(_endpoints.at("api.token.invalidate"), "api_key"_a = _apiKey, "access_token"_a = _accessToken));
+            _endpoint("api.token.invalidate", "api_key"_a = _apiKey, "access_token"_a = _accessToken));
     };
 
     // user:
@@ -183,8 +245,8 @@ class kite {
      */
     userProfile profile() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("user.profile"));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("user.profile"));
 
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (profile())"); };
 
@@ -201,8 +263,8 @@ class kite {
      */
     allMargins getMargins() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("user.margins"));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("user.margins"));
 
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getMargins())"); };
 
@@ -220,8 +282,8 @@ class kite {
      */
     margins getMargins(const string& segment) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, FMT(_endpoints.at("user.margins.segment"), "segment"_a = segment));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("user.margins.segment", "segment"_a = segment));
 
         if (!res.IsObject()) {
             throw libException("Empty data was received where it wasn't expected (getMargins(segment))");
@@ -262,35 +324,59 @@ class kite {
         double SL = DEFAULTDOUBLE, double trailSL = DEFAULTDOUBLE, int discQuantity = DEFAULTINT,
         const string& tag = "") {
 
-        std::vector<std::pair<string, string>> bodyParams = {
+        rju::_document res;
+        _sendReq(res, _placeOrderReq(variety, exchange, symbol, txnType, quantity, product, orderType, price, validity,
+                          trigPrice, sqOff, SL, trailSL, discQuantity, tag));
 
-            { "exchange", exchange },
-            { "tradingsymbol", symbol },
-            { "transaction_type", txnType },
-            { "quantity", std::to_string(quantity) },
-            { "product", product },
-            { "order_type", orderType },
-
-        };
+        return _orderIDOf(res, "placeOrder");
+    };
 
-        if (!std::isnan(price)) { bodyParams.emplace_back("price", std::to_string(price)); }
-        if (!validity.empty()) { bodyParams.emplace_back("validity", validity); }
-        if (!std::isnan(discQuantity)) { bodyParams.emplace_back("disclosed_quantity", std::to_string(discQuantity)); }
-        if (!std::isnan(trigPrice)) { bodyParams.emplace_back("trigger_price", std::to_string(trigPrice)); }
-        if (!std::isnan(sqOff)) { bodyParams.emplace_back("squareoff", std::to_string(sqOff)); }
-        if (!std::isnan(SL)) { bodyParams.emplace_back("stoploss", std::to_string(SL)); }
-        if (!std::isnan(trailSL)) { bodyParams.emplace_back("trailing_stoploss", std::to_string(trailSL)); }
-        if (!tag.empty()) { bodyParams.emplace_back("tag", tag); }
+    /**
+     * @brief same as placeOrder() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<string> orderID
+     */
+    callResult<string> tryPlaceOrder(const string& variety, const string& exchange, const string& symbol,
+        const string& txnType, int quantity, const string& product, const string& orderType,
+        double price = DEFAULTDOUBLE, const string& validity = "", double trigPrice = DEFAULTDOUBLE,
+        double sqOff = DEFAULTDOUBLE, double SL = DEFAULTDOUBLE, double trailSL = DEFAULTDOUBLE,
+        int discQuantity = DEFAULTINT, const string& tag = "") {
+
+        return _tryOrderReq(_placeOrderReq(variety, exchange, symbol, txnType, quantity, product, orderType, price,
+                                validity, trigPrice, sqOff, SL, trailSL, discQuantity, tag),
+            "tryPlaceOrder");
+    };
 
-        rj::Document res;
-        _sendReq(res, _methods::POST, FMT(_endpoints.at("order.place"), "variety"_a = variety), bodyParams);
+    /**
+     * @brief place an order from a prepared order. Only quantity, price and trigger price are encoded per call; prices
+     * are rounded to the tick size of the prepared order
+     *
+     * @param ord prepared order
+     * @param quantity
+     * @param price
+     * @param trigPrice trigger price
+     *
+     * @return string orderID
+     */
+    string placeOrder(
+        const preparedOrder& ord, int quantity, double price = DEFAULTDOUBLE, double trigPrice = DEFAULTDOUBLE) {
 
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (placeOrder)"); };
+        rju::_document res;
+        _sendReq(res, _placeOrderReq(ord, quantity, price, trigPrice));
 
-        string rcvdOrdID;
-        rju::_getIfExists(res["data"].GetObject(), rcvdOrdID, "order_id");
+        return _orderIDOf(res, "placeOrder");
+    };
 
-        return rcvdOrdID;
+    /**
+     * @brief same as placeOrder() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<string> orderID
+     */
+    callResult<string> tryPlaceOrder(
+        const preparedOrder& ord, int quantity, double price = DEFAULTDOUBLE, double trigPrice = DEFAULTDOUBLE) {
+        return _tryOrderReq(_placeOrderReq(ord, quantity, price, trigPrice), "tryPlaceOrder");
     };
 
     /**
@@ -315,26 +401,58 @@ class kite {
         int quantity = DEFAULTINT, double price = DEFAULTDOUBLE, const string& ordType = "",
         double trigPrice = DEFAULTDOUBLE, const string& validity = "", int discQuantity = DEFAULTINT) {
 
-        std::vector<std::pair<string, string>> bodyParams = {};
+        rju::_document res;
+        _sendReq(res,
+            _modifyOrderReq(variety, ordID, parentOrdID, quantity, price, ordType, trigPrice, validity, discQuantity));
 
-        if (!parentOrdID.empty()) { bodyParams.emplace_back("parent_order_id", parentOrdID); }
-        if (!std::isnan(quantity)) { bodyParams.emplace_back("quantity", std::to_string(quantity)); }
-        if (!std::isnan(price)) { bodyParams.emplace_back("price", std::to_string(price)); }
-        if (!ordType.empty()) { bodyParams.emplace_back("order_type", ordType); }
-        if (!std::isnan(trigPrice)) { bodyParams.emplace_back("trigger_price", std::to_string(trigPrice)); }
-        if (!validity.empty()) { bodyParams.emplace_back("validity", validity); }
-        if (!std::isnan(discQuantity)) { bodyParams.emplace_back("disclosed_quantity", std::to_string(discQuantity)); }
+        return _orderIDOf(res, "modifyOrder");
+    };
 
-        rj::Document res;
-        _sendReq(res, _methods::PUT, FMT(_endpoints.at("order.modify"), "variety"_a = variety, "order_id"_a = ordID),
-            bodyParams);
+    /**
+     * @brief same as modifyOrder() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<string> order ID
+     */
+    callResult<string> tryModifyOrder(const string& variety, const string& ordID, const string& parentOrdID = "",
+        int quantity = DEFAULTINT, double price = DEFAULTDOUBLE, const string& ordType = "",
+        double trigPrice = DEFAULTDOUBLE, const string& validity = "", int discQuantity = DEFAULTINT) {
 
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (modifyOrder)"); };
+        return _tryOrderReq(
+            _modifyOrderReq(variety, ordID, parentOrdID, quantity, price, ordType, trigPrice, validity, discQuantity),
+            "tryModifyOrder");
+    };
 
-        string rcvdOrdID;
-        rju::_getIfExists(res["data"].GetObject(), rcvdOrdID, "order_id");
+    /**
+     * @brief modify an order placed with a prepared order. Order type and validity of the prepared order are sent
+     * along with quantity, price and trigger price
+     *
+     * @param ord prepared order
+     * @param ordID order ID
+     * @param quantity
+     * @param price
+     * @param trigPrice trigger price
+     *
+     * @return string order ID
+     */
+    string modifyOrder(const preparedOrder& ord, const string& ordID, int quantity, double price = DEFAULTDOUBLE,
+        double trigPrice = DEFAULTDOUBLE) {
 
-        return rcvdOrdID;
+        rju::_document res;
+        _sendReq(res, _modifyOrderReq(ord, ordID, quantity, price, trigPrice));
+
+        return _orderIDOf(res, "modifyOrder");
+    };
+
+    /**
+     * @brief same as modifyOrder() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<string> order ID
+     */
+    callResult<string> tryModifyOrder(const preparedOrder& ord, const string& ordID, int quantity,
+        double price = DEFAULTDOUBLE, double trigPrice = DEFAULTDOUBLE) {
+        return _tryOrderReq(_modifyOrderReq(ord, ordID, quantity, price, trigPrice), "tryModifyOrder");
     };
 
     /**
@@ -351,19 +469,20 @@ class kite {
      */
     string cancelOrder(const string& variety, const string& ordID, const string& parentOrdID = "") {
 
-        rj::Document res;
-        (variety == "bo") ? _sendReq(res, _methods::DEL,
-                                FMT(_endpoints.at("order.cancel.bo"), "variety"_a = variety, "order_id"_a = ordID,
-                                    "parent_order_id"_a = parentOrdID)) :
-                            _sendReq(res, _methods::DEL,
-                                FMT(_endpoints.at("order.cancel"), "variety"_a = variety, "order_id"_a = ordID));
+        rju::_document res;
+        _sendReq(res, _cancelOrderReq(variety, ordID, parentOrdID));
 
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (cancelOrder)"); };
-
-        string rcvdOrdID;
-        rju::_getIfExists(res["data"].GetObject(), rcvdOrdID, "order_id");
+        return _orderIDOf(res, "cancelOrder");
+    };
 
-        return rcvdOrdID;
+    /**
+     * @brief same as cancelOrder() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<string> order ID
+     */
+    callResult<string> tryCancelOrder(const string& variety, const string& ordID, const string& parentOrdID = "") {
+        return _tryOrderReq(_cancelOrderReq(variety, ordID, parentOrdID), "tryCancelOrder");
     };
 
     /**
@@ -392,18 +511,64 @@ class kite {
      */
     std::vector<order> orders() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("orders"));
-
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (orders())"); };
-        if (!res["data"].IsArray()) { throw libException("Array was expected (orders())"); };
-
         std::vector<order> orderVec;
-        for (auto& i : res["data"].GetArray()) { orderVec.emplace_back(i.GetObject()); }
+        _sendSAXReq(orderVec, _endpoint("orders"), "orders()");
 
         return orderVec;
     };
 
+    /**
+     * @brief get list of orders as compact structs
+     *
+     * @return compactResult<std::vector<compactOrder>>
+     */
+    compactResult<std::vector<compactOrder>> ordersCompact() {
+
+        compactResult<std::vector<compactOrder>> res;
+        _sendCompactReq(res, _endpoint("orders"), "ordersCompact()");
+
+        return res;
+    };
+
+    /**
+     * @brief bring a snapshot of the day's orders up to date. Orders whose status, timestamps, quantities and prices
+     * are unchanged since the last sync aren't parsed again; the ones that are added or changed are listed in
+     * `snap.changed`
+     *
+     * @param snap snapshot to update. Pass the same snapshot to every sync
+     *
+     * @return const std::vector<const order*>& orders that were added or changed
+     */
+    const std::vector<const order*>& syncOrders(orderSnapshot& snap) {
+
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("orders"));
+
+        snap.changed.clear();
+        for (auto& i : _dataArray(res, "syncOrders()")) {
+
+            if (!i.IsObject()) { continue; };
+            const uint64_t hash = _orderHash(i);
+            const string ordID(_memberView(i, "order_id"));
+
+            auto it = snap._index.find(ordID);
+            if (it == snap._index.end()) {
+
+                snap._index.emplace(ordID, snap.orders.size());
+                snap._hashes.push_back(hash);
+                snap.changed.push_back(&snap.orders.emplace_back(i.GetObject()));
+            } else if (snap._hashes[it->second] != hash) {
+
+                snap._hashes[it->second] = hash;
+                order& ord = snap.orders[it->second];
+                ord.parse(i.GetObject());
+                snap.changed.push_back(&ord);
+            };
+        };
+
+        return snap.changed;
+    };
+
     /**
      * @brief get history of an order
      *
@@ -416,17 +581,8 @@ class kite {
      */
     std::vector<order> orderHistory(const string& ordID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, FMT(_endpoints.at("order.info"), "order_id"_a = ordID));
-
-        if (!res.IsObject()) {
-            throw libException("Empty data was received where it wasn't expected (orderHistory())");
-        };
-
-        if (!res["data"].IsArray()) { throw libException("Array was expected (orderHistory())"); };
-
         std::vector<order> orderVec;
-        for (auto& i : res["data"].GetArray()) { orderVec.emplace_back(i.GetObject()); }
+        _sendSAXReq(orderVec, _endpoint("order.info", "order_id"_a = ordID), "orderHistory()");
 
         return orderVec;
     };
@@ -441,18 +597,52 @@ class kite {
      */
     std::vector<trade> trades() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("trades"));
-
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (trades())"); };
-        if (!res["data"].IsArray()) { throw libException("Array was expected (trades())"); };
-
         std::vector<trade> tradeVec;
-        for (auto& i : res["data"].GetArray()) { tradeVec.emplace_back(i.GetObject()); }
+        _sendSAXReq(tradeVec, _endpoint("trades"), "trades()");
 
         return tradeVec;
     };
 
+    /**
+     * @brief get list of trades as compact structs
+     *
+     * @return compactResult<std::vector<compactTrade>>
+     */
+    compactResult<std::vector<compactTrade>> tradesCompact() {
+
+        compactResult<std::vector<compactTrade>> res;
+        _sendCompactReq(res, _endpoint("trades"), "tradesCompact()");
+
+        return res;
+    };
+
+    /**
+     * @brief bring a snapshot of the day's trades up to date. Only trades that weren't in the snapshot are parsed; they
+     * are listed in `snap.added`
+     *
+     * @param snap snapshot to update. Pass the same snapshot to every sync
+     *
+     * @return const std::vector<const trade*>& trades that were added
+     */
+    const std::vector<const trade*>& syncTrades(tradeSnapshot& snap) {
+
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("trades"));
+
+        snap.added.clear();
+        for (auto& i : _dataArray(res, "syncTrades()")) {
+
+            if (!i.IsObject()) { continue; };
+            const string tradeID(_memberView(i, "trade_id"));
+            if (snap._index.find(tradeID) != snap._index.end()) { continue; };
+
+            snap._index.emplace(tradeID, snap.trades.size());
+            snap.added.push_back(&snap.trades.emplace_back(i.GetObject()));
+        };
+
+        return snap.added;
+    };
+
     /**
      * @brief get the list of trades executed for a particular order.
      *
@@ -465,16 +655,8 @@ class kite {
      */
     std::vector<trade> orderTrades(const string& ordID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, FMT(_endpoints.at("order.trades"), "order_id"_a = ordID));
-
-        if (!res.IsObject()) {
-            throw libException("Empty data was received where it wasn't expected (orderTrades())");
-        };
-        if (!res["data"].IsArray()) { throw libException("Array was expected (orderTrades())"); };
-
         std::vector<trade> tradeVec;
-        for (auto& i : res["data"].GetArray()) { tradeVec.emplace_back(i.GetObject()); }
+        _sendSAXReq(tradeVec, _endpoint("order.trades", "order_id"_a = ordID), "orderTrades()");
 
         return tradeVec;
     };
@@ -550,8 +732,8 @@ class kite {
             params.PushBack(tmpVal, paramsAlloc);
         };
 
-        rj::Document res;
-        _sendReq(res, _methods::POST, _endpoints.at("gtt.place"),
+        rju::_document res;
+        _sendReq(res, _methods::POST, _endpoint("gtt.place"),
             {
 
                 { "type", trigType }, { "condition", rju::_dump(condition) }, { "orders", rju::_dump(params) }
@@ -576,8 +758,8 @@ class kite {
      */
     std::vector<GTT> getGTTs() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("gtt"));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("gtt"));
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getGTTs)"); };
         if (!res["data"].IsArray()) { throw libException("Array was expected (getGTTs())"); };
 
@@ -587,6 +769,19 @@ class kite {
         return gttVec;
     };
 
+    /**
+     * @brief get list of GTTs as compact structs
+     *
+     * @return compactResult<std::vector<compactGTT>>
+     */
+    compactResult<std::vector<compactGTT>> getGTTsCompact() {
+
+        compactResult<std::vector<compactGTT>> res;
+        _sendCompactReq(res, _endpoint("gtt"), "getGTTsCompact()");
+
+        return res;
+    };
+
     /**
      * @brief get details of a GTT
      *
@@ -598,8 +793,8 @@ class kite {
      */
     GTT getGTT(int trigID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, FMT(_endpoints.at("gtt.info"), "trigger_id"_a = trigID));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("gtt.info", "trigger_id"_a = trigID));
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getGTT)"); };
 
         return GTT(res["data"].GetObject());
@@ -674,8 +869,8 @@ class kite {
             params.PushBack(tmpVal, paramsAlloc);
         };
 
-        rj::Document res;
-        _sendReq(res, _methods::PUT, FMT(_endpoints.at("gtt.modify"), "trigger_id"_a = trigID),
+        rju::_document res;
+        _sendReq(res, _methods::PUT, _endpoint("gtt.modify", "trigger_id"_a = trigID),
             {
 
                 { "type", trigType }, { "condition", rju::_dump(condition) }, { "orders", rju::_dump(params) }
@@ -702,8 +897,8 @@ class kite {
      */
     int deleteGTT(int trigID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::DEL, FMT(_endpoints.at("gtt.delete"), "trigger_id"_a = trigID));
+        rju::_document res;
+        _sendReq(res, _methods::DEL, _endpoint("gtt.delete", "trigger_id"_a = trigID));
 
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (deleteGTT)"); };
 
@@ -725,18 +920,25 @@ class kite {
      */
     std::vector<holding> holdings() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("portfolio.holdings"));
-
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (holdings)"); };
-        if (!res["data"].IsArray()) { throw libException("Array was expected (holdinga)"); };
-
         std::vector<holding> holdingsVec;
-        for (auto& i : res["data"].GetArray()) { holdingsVec.emplace_back(i.GetObject()); }
+        _sendSAXReq(holdingsVec, _endpoint("portfolio.holdings"), "holdings");
 
         return holdingsVec;
     };
 
+    /**
+     * @brief get holdings as compact structs
+     *
+     * @return compactResult<std::vector<compactHolding>>
+     */
+    compactResult<std::vector<compactHolding>> holdingsCompact() {
+
+        compactResult<std::vector<compactHolding>> res;
+        _sendCompactReq(res, _endpoint("portfolio.holdings"), "holdingsCompact()");
+
+        return res;
+    };
+
     /**
      * @brief get positions
      *
@@ -747,11 +949,23 @@ class kite {
      */
     positions getPositions() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("portfolio.positions"));
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getPositions)"); };
+        positions pos;
+        _sendSAXReq(pos, _endpoint("portfolio.positions"), "getPositions");
 
-        return positions(res["data"].GetObject());
+        return pos;
+    };
+
+    /**
+     * @brief get positions as compact structs
+     *
+     * @return compactResult<compactPositions>
+     */
+    compactResult<compactPositions> getPositionsCompact() {
+
+        compactResult<compactPositions> res;
+        _sendCompactReq(res, _endpoint("portfolio.positions"), "getPositionsCompact()");
+
+        return res;
     };
 
     /**
@@ -785,8 +999,8 @@ class kite {
 
         };
 
-        rj::Document res;
-        _sendReq(res, _methods::PUT, _endpoints.at("portfolio.positions.convert"), bodyParams);
+        rju::_document res;
+        _sendReq(res, _methods::PUT, _endpoint("portfolio.positions.convert"), bodyParams);
         if (!res.IsObject()) {
             throw libException("Empty data was received where it wasn't expected (convertPosition)");
         };
@@ -813,21 +1027,18 @@ class kite {
      */
     std::vector<instrument> getInstruments(const string& exchange = "") {
 
-        const string rcvdData =
-            (exchange.empty()) ? _sendInstrumentsReq(_endpoints.at("market.instruments.all")) :
-                                 _sendInstrumentsReq(FMT(_endpoints.at("market.instruments"), "exchange"_a = exchange));
-        if (rcvdData.empty()) { return {}; };
-
-        std::vector<string> tokens = kc::_split(rcvdData, '\n');
-        tokens.pop_back(); // because last token is empty since empty tokens aren't ignored
+        // rows are parsed as they're downloaded, the whole CSV is never held in memory
+        std::vector<instrument> instruments;
+        kc::_csvParser parser(
+            [&instruments](const std::vector<std::string_view>& fields) { instruments.emplace_back(fields); });
 
-        for (auto& tok : tokens) {
+        _sendInstrumentsReq(
+            (exchange.empty()) ? _endpoint("market.instruments.all") :
+                                 _endpoint("market.instruments", "exchange"_a = exchange),
+            [&parser](const char* data, size_t size) { parser.feed(data, size); });
+        parser.finish();
 
-            // sent data has \r\n as delimiter and _split only removes \n. pop_back() to remove that \r
-            tok.pop_back();
-        };
-
-        return { ++tokens.begin(), tokens.end() }; //++ to skip first iteration (headers)
+        return instruments;
     };
 
     /**
@@ -842,17 +1053,26 @@ class kite {
      */
     std::unordered_map<string, quote> getQuote(const std::vector<string>& symbols) {
 
-        rj::Document res;
-        _sendReq(
-            res, _methods::GET, FMT(_endpoints.at("market.quote"), "symbols_list"_a = _encodeSymbolsList(symbols)));
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getQuote)"); };
-
         std::unordered_map<string, quote> quoteMap;
-        for (auto& i : res["data"].GetObject()) { quoteMap.emplace(i.name.GetString(), i.value.GetObject()); };
+        _sendSAXReq(quoteMap, _endpoint("market.quote", "symbols_list"_a = _encodeSymbolsList(symbols)), "getQuote");
 
         return quoteMap;
     };
 
+    /**
+     * @brief same as getQuote() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<std::unordered_map<string, quote>>
+     */
+    callResult<std::unordered_map<string, quote>> tryGetQuote(const std::vector<string>& symbols) {
+
+        callResult<std::unordered_map<string, quote>> result;
+        _trySendSAXReq(result.value, _endpoint("market.quote", "symbols_list"_a = _encodeSymbolsList(symbols)),
+            result.error, "tryGetQuote");
+        return result;
+    };
+
     /**
      * @brief Retrieve OHLC for list of instruments
      *
@@ -865,17 +1085,27 @@ class kite {
      */
     std::unordered_map<string, OHLCQuote> getOHLC(const std::vector<string>& symbols) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET,
-            FMT(_endpoints.at("market.quote.ohlc"), "symbols_list"_a = _encodeSymbolsList(symbols)));
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getOHLC)"); };
-
         std::unordered_map<string, OHLCQuote> quoteMap;
-        for (auto& i : res["data"].GetObject()) { quoteMap.emplace(i.name.GetString(), i.value.GetObject()); };
+        _sendSAXReq(quoteMap, _endpoint("market.quote.ohlc", "symbols_list"_a = _encodeSymbolsList(symbols)),
+            "getOHLC");
 
         return quoteMap;
     };
 
+    /**
+     * @brief same as getOHLC() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<std::unordered_map<string, OHLCQuote>>
+     */
+    callResult<std::unordered_map<string, OHLCQuote>> tryGetOHLC(const std::vector<string>& symbols) {
+
+        callResult<std::unordered_map<string, OHLCQuote>> result;
+        _trySendSAXReq(result.value, _endpoint("market.quote.ohlc", "symbols_list"_a = _encodeSymbolsList(symbols)),
+            result.error, "tryGetOHLC");
+        return result;
+    };
+
     /**
      * @brief Retrieve last price for list of instruments
      *
@@ -888,17 +1118,26 @@ class kite {
      */
     std::unordered_map<string, LTPQuote> getLTP(const std::vector<string>& symbols) {
 
-        rj::Document res;
-        _sendReq(
-            res, _methods::GET, FMT(_endpoints.at("market.quote.ltp"), "symbols_list"_a = _encodeSymbolsList(symbols)));
-        if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getLTP)"); };
-
         std::unordered_map<string, LTPQuote> quoteMap;
-        for (auto& i : res["data"].GetObject()) { quoteMap.emplace(i.name.GetString(), i.value.GetObject()); };
+        _sendSAXReq(quoteMap, _endpoint("market.quote.ltp", "symbols_list"_a = _encodeSymbolsList(symbols)), "getLTP");
 
         return quoteMap;
     };
 
+    /**
+     * @brief same as getLTP() but errors returned by REST API are returned instead of being thrown. Errors of the
+     * library itself are still thrown
+     *
+     * @return callResult<std::unordered_map<string, LTPQuote>>
+     */
+    callResult<std::unordered_map<string, LTPQuote>> tryGetLTP(const std::vector<string>& symbols) {
+
+        callResult<std::unordered_map<string, LTPQuote>> result;
+        _trySendSAXReq(result.value, _endpoint("market.quote.ltp", "symbols_list"_a = _encodeSymbolsList(symbols)),
+            result.error, "tryGetLTP");
+        return result;
+    };
+
     // historical:
 
     /**
@@ -919,9 +1158,9 @@ class kite {
     std::vector<historicalData> getHistoricalData(int instrumentTok, const string& from, const string& to,
         const string& interval, bool continuous = false, bool oi = false) {
 
-        rj::Document res;
+        rju::_document res;
         _sendReq(res, _methods::GET,
-            FMT(_endpoints.at("market.historical"), "instrument_token"_a = instrumentTok, "interval"_a = interval,
+            _endpoint("market.historical", "instrument_token"_a = instrumentTok, "interval"_a = interval,
                 "from"_a = from, "to"_a = to, "continuous"_a = static_cast<int>(continuous),
                 "oi"_a = static_cast<int>(oi)));
         if (!res.IsObject()) {
@@ -935,6 +1174,34 @@ class kite {
         return dataVec;
     };
 
+    /**
+     * @brief Retrieve historical data (candles) for an instrument in column-wise form. Same as `getHistoricalData()`
+     * but timestamps are parsed to nanoseconds since the unix epoch and the response is parsed without building a DOM.
+     *
+     * @param instrumentTok instrument token (NOT trading symbol)
+     * @param from from date in the following format: yyyy-mm-dd HH:MM:SS
+     * @param to to date in the following format: yyyy-mm-dd HH:MM:SS
+     * @param interval candle interval
+     * @param continuous boolean flag to get continuous data for futures and options instruments
+     * @param oi boolean flag to get open interest data
+     *
+     *  @return historicalCandles
+     */
+    historicalCandles getHistoricalCandles(int instrumentTok, const string& from, const string& to,
+        const string& interval, bool continuous = false, bool oi = false) {
+
+        string res = _sendRawReq(_methods::GET,
+            _endpoint("market.historical", "instrument_token"_a = instrumentTok, "interval"_a = interval,
+                "from"_a = from, "to"_a = to, "continuous"_a = static_cast<int>(continuous),
+                "oi"_a = static_cast<int>(oi)));
+        _parseScope scope(*this);
+        if (res.empty()) {
+            throw libException("Empty data was received where it wasn't expected (getHistoricalCandles)");
+        };
+
+        return historicalCandles(res);
+    };
+
     // MF:
 
     /**
@@ -965,8 +1232,8 @@ class kite {
         if (!std::isnan(amount)) { bodyParams.emplace_back("amount", std::to_string(amount)); }
         if (!tag.empty()) { bodyParams.emplace_back("tag", tag); }
 
-        rj::Document res;
-        _sendReq(res, _methods::POST, _endpoints.at("mf.order.place"), bodyParams);
+        rju::_document res;
+        _sendReq(res, _methods::POST, _endpoint("mf.order.place"), bodyParams);
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (placeMFOrder)"); };
 
         string rcvdOrdID;
@@ -987,8 +1254,8 @@ class kite {
      */
     string cancelMFOrder(const string& ordID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::DEL, FMT(_endpoints.at("mf.order.cancel"), "order_id"_a = ordID));
+        rju::_document res;
+        _sendReq(res, _methods::DEL, _endpoint("mf.order.cancel", "order_id"_a = ordID));
         if (!res.IsObject()) {
             throw libException("Empty data was received where it wasn't expected (cancelMFOrder)");
         };
@@ -1009,8 +1276,8 @@ class kite {
      */
     std::vector<MFOrder> getMFOrders() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("mf.orders"));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("mf.orders"));
 
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getMFOrders)"); };
         auto it = res.FindMember("data");
@@ -1034,8 +1301,8 @@ class kite {
      */
     MFOrder getMFOrder(const string& ordID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, FMT(_endpoints.at("mf.order.info"), "order_id"_a = ordID));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("mf.order.info", "order_id"_a = ordID));
 
         if (!res.IsObject()) {
             throw libException("Empty data was received where it wasn't expected (cancelMFOrder)");
@@ -1054,8 +1321,8 @@ class kite {
      */
     std::vector<MFHolding> getMFHoldings() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("mf.holdings"));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("mf.holdings"));
 
         if (!res.IsObject()) {
             throw libException("Empty data was received where it wasn't expected (getMFHoldings)");
@@ -1104,8 +1371,8 @@ class kite {
         if (!std::isnan(installDay)) { bodyParams.emplace_back("instalment_day", std::to_string(installDay)); };
         if (!tag.empty()) { bodyParams.emplace_back("tag", tag); };
 
-        rj::Document res;
-        _sendReq(res, _methods::POST, _endpoints.at("mf.sip.place"), bodyParams);
+        rju::_document res;
+        _sendReq(res, _methods::POST, _endpoint("mf.sip.place"), bodyParams);
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (placeMFSIP)"); };
 
         string rcvdOrdID, rcvdSipID;
@@ -1139,8 +1406,8 @@ class kite {
         if (!freq.empty()) { bodyParams.emplace_back("frequency", freq); }
         if (!std::isnan(installDay)) { bodyParams.emplace_back("instalment_day", std::to_string(installDay)); }
 
-        rj::Document res;
-        _sendReq(res, _methods::PUT, FMT(_endpoints.at("mf.sip.modify"), "sip_id"_a = SIPID), bodyParams);
+        rju::_document res;
+        _sendReq(res, _methods::PUT, _endpoint("mf.sip.modify", "sip_id"_a = SIPID), bodyParams);
     };
 
     /**
@@ -1155,8 +1422,8 @@ class kite {
      */
     string cancelMFSIP(const string& SIPID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::DEL, FMT(_endpoints.at("mf.sip.cancel"), "sip_id"_a = SIPID));
+        rju::_document res;
+        _sendReq(res, _methods::DEL, _endpoint("mf.sip.cancel", "sip_id"_a = SIPID));
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (placeMFSIP)"); };
 
         string rcvdSipID;
@@ -1175,8 +1442,8 @@ class kite {
      */
     std::vector<MFSIP> getSIPs() {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, _endpoints.at("mf.sips"));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("mf.sips"));
 
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getSIPs)"); };
         auto it = res.FindMember("data");
@@ -1200,8 +1467,8 @@ class kite {
      */
     MFSIP getSIP(const string& SIPID) {
 
-        rj::Document res;
-        _sendReq(res, _methods::GET, FMT(_endpoints.at("mf.sip.info"), "sip_id"_a = SIPID));
+        rju::_document res;
+        _sendReq(res, _methods::GET, _endpoint("mf.sip.info", "sip_id"_a = SIPID));
 
         if (!res.IsObject()) { throw libException("Empty data was received where it wasn't expected (getSIP)"); };
 
@@ -1218,19 +1485,15 @@ class kite {
      */
     std::vector<MFInstrument> getMFInstruments() {
 
-        const string rcvdData = _sendInstrumentsReq(_endpoints.at("mf.instruments"));
-
-        if (rcvdData.empty()) { return {}; };
-        std::vector<string> tokens = kc::_split(rcvdData, '\n');
-        tokens.pop_back(); // because last token is empty since empty tokens aren't ignored
+        std::vector<MFInstrument> instruments;
+        kc::_csvParser parser(
+            [&instruments](const std::vector<std::string_view>& fields) { instruments.emplace_back(fields); });
 
-        for (auto& tok : tokens) {
-
-            // sent data has \r\n as delimiter and _split only removes \n. pop_back() to remove that \r
-            tok.pop_back();
-        };
+        _sendInstrumentsReq(
+            _endpoint("mf.instruments"), [&parser](const char* data, size_t size) { parser.feed(data, size); });
+        parser.finish();
 
-        return { ++tokens.begin(), tokens.end() }; //++ to skip first iteration (headers)
+        return instruments;
     };
 
     // others:
@@ -1281,8 +1544,8 @@ class kite {
             req.PushBack(paramVal, reqAlloc);
         };
 
-        rj::Document res;
-        _sendReq(res, _methods::POST, _endpoints.at("order.margins"), { { "", rju::_dump(req) } }, true);
+        rju::_document res;
+        _sendReq(res, _methods::POST, _endpoint("order.margins"), { { "", rju::_dump(req) } }, true);
         if (!res.IsObject()) {
             throw libException("Empty data was received where it wasn't expected (getOrderMargis)");
         };
@@ -1297,6 +1560,8 @@ class kite {
     };
 
   private:
+    friend class asyncClient;
+
     // member variables:
 
     string _apiKey = "";
@@ -1325,10 +1590,6 @@ class kite {
         { "trades", "/trades" },
 
         { "order.info", "/orders/{order_id}" },
-        { "order.place", "/orders/{variety}" },
-        { "order.modify", "/orders/{variety}/{order_id}" },
-        { "order.cancel", "/orders/{variety}/{order_id}" },
-        { "order.cancel.bo", "/orders/{variety}/{order_id}?parent_order_id={parent_order_id}" },
         { "order.trades", "/orders/{order_id}/trades" },
 
         // portfolio
@@ -1380,13 +1641,94 @@ class kite {
         { "order.margins", "/margins/orders" },
 
     };
+    restMetrics _metrics { _metricsEndpoints() }; // declared after _endpoints since it's initialized from it
+
+    httpTransport _httpTransport;
+    std::unique_ptr<transport> _transport; // used instead of _httpTransport if set
+    httplib::Headers _headers; // rebuilt only when the API key or access token changes
+
+    // a request whose response is yet to be parsed. Recorded by _recordRequest() once it has been
+    struct _pendingRequest {
+
+        std::string_view endpoint;
+        requestTimings timings;
+        int64_t total = 0;
+        bool set = false;
+    };
+
+    // path of a request and key of its endpoint, which restMetrics records the request under
+    struct _route {
+
+        std::string_view key;
+        const string* _path = nullptr; // paths without variables point into _endpoints instead of being copied
+        string _formatted;
+
+        const string& path() const { return (_path != nullptr) ? *_path : _formatted; };
+    };
+
+    // times parsing of the response to the pending request of the calling thread and records the request when it goes
+    // out of scope, including when parsing throws
+    class _parseScope {
+
+      public:
+        explicit _parseScope(kite& Kite): _kite(Kite), _start(_steadyNs()) {};
 
-    httplib::Client _httpClient;
+        _parseScope(const _parseScope&) = delete;
+        _parseScope& operator=(const _parseScope&) = delete;
+
+        ~_parseScope() { _kite._recordRequest(_steadyNs() - _start); };
+
+      private:
+        kite& _kite;
+        const int64_t _start;
+    };
 
     // methods:
 
+    // route of an endpoint
+    _route _endpoint(const char* key) const {
+
+        auto it = _endpoints.find(key);
+        if (it == _endpoints.end()) { throw libException(FMT("Unknown endpoint {0} (_endpoint)", key)); };
+
+        return { it->first, &it->second, {} };
+    };
+
+    // route of an endpoint whose path has variables, filled in from args
+    template <typename... Args> _route _endpoint(const char* key, Args&&... args) const {
+
+        const _route route = _endpoint(key);
+        return { route.key, nullptr, FMT(*route._path, std::forward<Args>(args)...) };
+    };
+
+    std::vector<string> _metricsEndpoints() const {
+
+        std::vector<string> keys(_pathKeys.begin(), _pathKeys.end());
+        for (const auto& endpoint : _endpoints) { keys.push_back(endpoint.first); };
+        return keys;
+    };
+
+    // thread local since a thread sends one request at a time
+    static _pendingRequest& _pending() {
+        thread_local _pendingRequest pending;
+        return pending;
+    };
+
+    // records the pending request of the calling thread, if there's one
+    void _recordRequest(int64_t parse) {
+
+        _pendingRequest& pending = _pending();
+        if (!pending.set) { return; };
+
+        pending.set = false;
+        pending.timings.parse = parse;
+        _metrics._record(pending.endpoint, pending.timings, pending.total + parse);
+    };
+
     string _getAuthStr() const { return FMT("token {0}:{1}", _apiKey, _accessToken); };
 
+    void _updateHeaders() { _headers = { { "Authorization", _getAuthStr() }, { "X-Kite-Version", _kiteVersion } }; };
+
     static string _encodeSymbolsList(const std::vector<string>& symbols) {
 
         string str;
@@ -1409,16 +1751,16 @@ class kite {
 
         for (const auto& param : params) {
 
-            //! could cause problems because there will that `&` after last query. can be solved by scraping the last
-            //! char of string after the for loop
-            str.append(FMT("{0}={1}&", param.first, param.second));
+            if (!str.empty()) { str.push_back('&'); };
+            str.append(param.first).push_back('=');
+            _appendURLEncoded(str, param.second);
         };
 
         return str;
     };
 
-    // GMock requires mock methods to be virtual
-    virtual void _sendReq(rj::Document& data, const _methods& mtd, const string& endpoint,
+    // sends the request and parses the response into data. Errors returned by REST API are thrown as exceptions
+    void _sendReq(rju::_document& data, const _methods& mtd, const _route& endpoint,
         const std::vector<std::pair<string, string>>& bodyParams = {}, bool isJson = false) {
 
         /*
@@ -1426,123 +1768,307 @@ class kite {
         bodyParam's first pair with first element being empty string. see orderMargins() function
         */
 
-        // create request
-        const httplib::Headers headers = {
+        apiError err;
+        if (!_trySendReq(data, mtd, endpoint, err, bodyParams, isJson)) { kc::_throwException(err); };
+    };
+
+    // sends a request built by _requestBuilder and parses the response into data
+    void _sendReq(rju::_document& data, const _requestBuilder& req) {
+
+        apiError err;
+        if (!_trySendReq(data, req, err)) { kc::_throwException(err); };
+    };
+
+    // same as _sendReq() but errors returned by REST API are returned in err. Returns false for them
+    bool _trySendReq(rju::_document& data, const _methods& mtd, const _route& endpoint, apiError& err,
+        const std::vector<std::pair<string, string>>& bodyParams = {}, bool isJson = false) {
 
-            { "Authorization", _getAuthStr() }, { "X-Kite-Version", _kiteVersion }
+        string dataRcvd = _trySendRawReq(mtd, endpoint, err, bodyParams, isJson);
+        if (err) { return false; };
+
+        _parseRes(data, std::move(dataRcvd));
+        return true;
+    };
+
+    // same as _sendReq() but errors returned by REST API are returned in err. Returns false for them
+    bool _trySendReq(rju::_document& data, const _requestBuilder& req, apiError& err) {
+
+        string dataRcvd = _trySendHTTP(
+            req.method(), req.endpoint(), req.path().c_str(), err, req.body(), "application/x-www-form-urlencoded");
+        if (err) { return false; };
+
+        _parseRes(data, std::move(dataRcvd));
+        return true;
+    };
+
+    // parses a response into data and records the request it was received for
+    void _parseRes(rju::_document& data, string res) {
+
+        _parseScope scope(*this);
+
+        if (!res.empty()) {
+
+            data.parse(std::move(res));
+        } else {
+
+            // sets the document to a non-object entity on failure. array was chosen because no kite method returns
+            // `data` field with an array
+            data.Parse("[]");
         };
-        int code = 0;
-        string dataRcvd;
+    };
 
-        // this code can obviously be shortened but return type of client.Get() etc. doesn't have a default constructor,
-        // which means we cannot init an instance and then assign to it later
-        if (mtd == _methods::GET) {
+    _requestBuilder& _placeOrderReq(const string& variety, const string& exchange, const string& symbol,
+        const string& txnType, int quantity, const string& product, const string& orderType, double price,
+        const string& validity, double trigPrice, double sqOff, double SL, double trailSL, int discQuantity,
+        const string& tag) {
+
+        auto& req = _requestBuilder::local().begin<_path::ORDER_PLACE>(_methods::POST, variety);
+        req.param("exchange", exchange)
+            .param("tradingsymbol", symbol)
+            .param("transaction_type", txnType)
+            .param("quantity", quantity)
+            .param("product", product)
+            .param("order_type", orderType)
+            .paramIfSet("price", price)
+            .paramIfSet("validity", validity)
+            .paramIfSet("disclosed_quantity", discQuantity)
+            .paramIfSet("trigger_price", trigPrice)
+            .paramIfSet("squareoff", sqOff)
+            .paramIfSet("stoploss", SL)
+            .paramIfSet("trailing_stoploss", trailSL)
+            .paramIfSet("tag", tag);
+
+        return req;
+    };
 
-            if (auto res = _httpClient.Get(endpoint.c_str(), headers)) {
+    static _requestBuilder& _placeOrderReq(const preparedOrder& ord, int quantity, double price, double trigPrice) {
 
-                code = res->status;
-                dataRcvd = res->body;
-            } else {
+        auto& req =
+            _requestBuilder::local().begin(_methods::POST, ord._placePath, "order.place").encoded(ord._placeParams);
+        ord._appendVariable(req, quantity, price, trigPrice);
 
-                throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error()));
-            };
-        } else if (mtd == _methods::POST) {
+        return req;
+    };
 
-            if (auto res = _httpClient.Post(endpoint.c_str(), headers,
-                    (isJson) ? bodyParams[0].second : _encodeBody(bodyParams),
-                    (isJson) ? "application/json" : "application/x-www-form-urlencoded")) {
+    static _requestBuilder& _modifyOrderReq(const string& variety, const string& ordID, const string& parentOrdID,
+        int quantity, double price, const string& ordType, double trigPrice, const string& validity, int discQuantity) {
 
-                code = res->status;
-                dataRcvd = res->body;
-            } else {
+        auto& req = _requestBuilder::local().begin<_path::ORDER_MODIFY>(_methods::PUT, variety, ordID);
+        req.paramIfSet("parent_order_id", parentOrdID)
+            .paramIfSet("quantity", quantity)
+            .paramIfSet("price", price)
+            .paramIfSet("order_type", ordType)
+            .paramIfSet("trigger_price", trigPrice)
+            .paramIfSet("validity", validity)
+            .paramIfSet("disclosed_quantity", discQuantity);
 
-                throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error()));
-            };
-        } else if (mtd == _methods::PUT) {
+        return req;
+    };
 
-            if (auto res = _httpClient.Put(endpoint.c_str(), headers,
-                    (isJson) ? bodyParams[0].second : _encodeBody(bodyParams),
-                    (isJson) ? "application/json" : "application/x-www-form-urlencoded")) {
+    static _requestBuilder& _modifyOrderReq(
+        const preparedOrder& ord, const string& ordID, int quantity, double price, double trigPrice) {
 
-                code = res->status;
-                dataRcvd = res->body;
-            } else {
+        auto& req = _requestBuilder::local()
+                        .begin<_path::ORDER_MODIFY>(_methods::PUT, ord._variety, ordID)
+                        .encoded(ord._modifyParams);
+        ord._appendVariable(req, quantity, price, trigPrice);
 
-                throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error()));
-            };
-        } else if (mtd == _methods::DEL) {
+        return req;
+    };
 
-            if (auto res = _httpClient.Delete(endpoint.c_str(), headers)) {
+    static _requestBuilder& _cancelOrderReq(const string& variety, const string& ordID, const string& parentOrdID) {
+        return (variety == "bo") ?
+                   _requestBuilder::local().begin<_path::ORDER_CANCEL_BO>(_methods::DEL, variety, ordID, parentOrdID) :
+                   _requestBuilder::local().begin<_path::ORDER_CANCEL>(_methods::DEL, variety, ordID);
+    };
 
-                code = res->status;
-                dataRcvd = res->body;
-            } else {
+    // order ID of an order response
+    static string _orderIDOf(rju::_document& res, const char* caller) {
 
-                throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error()));
-            };
+        if (!res.IsObject()) {
+            throw libException(FMT("Empty data was received where it wasn't expected ({0})", caller));
         };
 
+        string rcvdOrdID;
+        rju::_getIfExists(res["data"].GetObject(), rcvdOrdID, "order_id");
+
+        return rcvdOrdID;
+    };
+
+    callResult<string> _tryOrderReq(const _requestBuilder& req, const char* caller) {
+
+        callResult<string> result;
+        rju::_document res;
+        if (_trySendReq(res, req, result.error)) { result.value = _orderIDOf(res, caller); };
+
+        return result;
+    };
+
+    // sends the request and returns the body as is. Errors returned by REST API are thrown as exceptions. Used by
+    // methods that parse the body without a DOM
+    string _sendRawReq(const _methods& mtd, const _route& endpoint,
+        const std::vector<std::pair<string, string>>& bodyParams = {}, bool isJson = false) {
+
+        apiError err;
+        string dataRcvd = _trySendRawReq(mtd, endpoint, err, bodyParams, isJson);
+        if (err) { kc::_throwException(err); };
+
+        return dataRcvd;
+    };
+
+    // same as _sendRawReq() but errors returned by REST API are returned in err. The body is empty for them
+    string _trySendRawReq(const _methods& mtd, const _route& endpoint, apiError& err,
+        const std::vector<std::pair<string, string>>& bodyParams = {}, bool isJson = false) {
+
+        const char* path = endpoint.path().c_str();
+        if (mtd == _methods::POST || mtd == _methods::PUT) {
+            return _trySendHTTP(mtd, endpoint.key, path, err,
+                (isJson) ? bodyParams[0].second : _encodeBody(bodyParams),
+                (isJson) ? "application/json" : "application/x-www-form-urlencoded");
+        };
+        return _trySendHTTP(mtd, endpoint.key, path, err);
+    };
+
+    // GMock requires mock methods to be virtual. Every request but instrument downloads is sent through this. Errors
+    // returned by REST API are returned in err and the body is empty for them. The request is left pending to be
+    // recorded in restMetrics under key once the caller has parsed the response
+    virtual string _trySendHTTP(const _methods& mtd, std::string_view key, const char* endpoint, apiError& err,
+        const string& body = "", const char* contentType = "") {
+
+        _pendingRequest& pending = _pending();
+        pending.endpoint = key;
+        pending.set = false;
+
+        // the default transport is final, so calls to it aren't virtual
+        const int64_t start = _steadyNs();
+        httpResponse res = (_transport) ? _transport->send(mtd, endpoint, _headers, body, contentType) :
+                                          _httpTransport.send(mtd, endpoint, _headers, body, contentType);
+        pending.timings = res.timings;
+        pending.total = _steadyNs() - start;
+        pending.set = true;
+
+        const int code = res.code;
+        string dataRcvd = std::move(res.body);
+
         //?std::cout << dataRcvd << std::endl;
 
-        if (!dataRcvd.empty()) {
+        if (code != 200) {
 
-            rju::_parse(data, dataRcvd);
+            _recordRequest(0);
+            err = _apiErrorOf(dataRcvd, code);
+            return "";
+        };
 
-            if (code != 200) {
+        return dataRcvd;
+    };
 
-                string excpStr;
-                string message;
+    // sends a GET request and parses `data` of the response straight into out, without building a DOM
+    template <typename T> void _sendSAXReq(T& out, const _route& endpoint, const char* caller) {
 
-                try {
+        apiError err;
+        if (!_trySendSAXReq(out, endpoint, err, caller)) { kc::_throwException(err); };
+    };
 
-                    if (!rju::_getIfExists(data, excpStr, "error_type")) { excpStr = "NoException"; };
-                    rju::_getIfExists(data, message, "message");
+    // same as _sendSAXReq() but errors returned by REST API are returned in err. Returns false for them
+    template <typename T> bool _trySendSAXReq(T& out, const _route& endpoint, apiError& err, const char* caller) {
 
-                } catch (const std::exception& e) {
+        string res = _trySendRawReq(_methods::GET, endpoint, err);
+        if (err) { return false; };
 
-                    throw libException(FMT("{0} was thrown while extracting excpStr({1}) and message({2}) (_sendReq)",
-                        e.what(), excpStr, message));
-                };
+        _parseSAXRes(std::move(res), out, caller);
+        return true;
+    };
 
-                kc::_throwException(excpStr, code, message);
-            };
-        } else {
+    // parses `data` of a response straight into out
+    template <typename T> void _parseSAXRes(string res, T& out, const char* caller) {
 
-            // sets the document to a non-object entity on failure. array was chosen because no kite method returns
-            // `data` field with an array
-            data.Parse("[]");
+        _parseScope scope(*this);
+        if (res.empty()) { throw libException(FMT("Empty data was received where it wasn't expected ({0})", caller)); };
+        if (!kc::_saxParse(res, out)) { throw libException(FMT("Unexpected data was received ({0})", caller)); };
+    };
+
+    // same as _sendSAXReq() but the response body is kept in out, since the string views of out.data point into it
+    template <typename T> void _sendCompactReq(compactResult<T>& out, const _route& endpoint, const char* caller) {
+
+        out._body = std::make_unique<string>(_sendRawReq(_methods::GET, endpoint));
+        _parseScope scope(*this);
+        if (out._body->empty()) {
+            throw libException(FMT("Empty data was received where it wasn't expected ({0})", caller));
+        };
+        if (!kc::_saxParse(*out._body, out.data)) {
+            throw libException(FMT("Unexpected data was received ({0})", caller));
         };
     };
 
-    // GMock requires mock methods to be virtual
-    virtual string _sendInstrumentsReq(const string& endpoint) {
+    // `data` array of a response
+    static rj::Value::Array _dataArray(rju::_document& res, const char* caller) {
 
-        // create request and send req
-        httplib::Headers headers = { { "Authorization", _getAuthStr() }, { "X-Kite-Version", _kiteVersion } };
-        int code = 0;
-        string dataRcvd;
+        if (!res.IsObject()) {
+            throw libException(FMT("Empty data was received where it wasn't expected ({0})", caller));
+        };
+        auto it = res.FindMember("data");
+        if (it == res.MemberEnd() || !it->value.IsArray()) {
+            throw libException(FMT("Unexpected data was received ({0})", caller));
+        };
 
-        if (auto res = _httpClient.Get(endpoint.c_str(), headers)) {
+        return it->value.GetArray();
+    };
 
-            code = res->status;
-            if (code == 200) { dataRcvd = res->body; };
-        } else {
+    // classifies an error response by its `error_type`. Bodies that aren't JSON objects are NoExceptions
+    static apiError _apiErrorOf(const string& body, int code) {
 
-            throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error()));
+        rj::Document data;
+        if (body.empty() || data.Parse(body.c_str()).HasParseError() || !data.IsObject()) {
+            return { errorType::NO_EXCEPTION, code, body };
         };
 
-        // get data
-        if (!dataRcvd.empty()) {
+        string excpStr;
+        string message;
 
-            if (code == 200) { return dataRcvd; }
+        try {
 
-            kc::_throwException("NoException", code, "");
-        } else {
+            if (!rju::_getIfExists(data, excpStr, "error_type")) { excpStr = "NoException"; };
+            rju::_getIfExists(data, message, "message");
 
-            return "";
+        } catch (const std::exception& e) {
+
+            throw libException(FMT("{0} was thrown while extracting excpStr({1}) and message({2}) (_sendReq)",
+                e.what(), excpStr, message));
+        };
+
+        return { kc::_errorTypeOf(excpStr), code, std::move(message) };
+    };
+
+    // GMock requires mock methods to be virtual
+    virtual void _sendInstrumentsReq(
+        const _route& endpoint, const std::function<void(const char* data, size_t size)>& receiver) {
+
+        /*
+        Body of a successful response is passed to `receiver` chunk by chunk as it's received instead of being collected
+        into a string first.
+        */
+
+        // parsing happens in receiver while the body is being read, so time spent in it is taken out of the read phase
+        int64_t parse = 0;
+        const auto timedReceiver = [&receiver, &parse](const char* data, size_t size) {
+            const int64_t parseStart = _steadyNs();
+            receiver(data, size);
+            parse += _steadyNs() - parseStart;
         };
 
-        return "";
+        // send req
+        const int64_t start = _steadyNs();
+        const char* path = endpoint.path().c_str();
+        httpResponse res = (_transport) ? _transport->stream(path, _headers, timedReceiver) :
+                                          _httpTransport.stream(path, _headers, timedReceiver);
+        res.timings.parse = parse;
+        res.timings.read = std::max<int64_t>(0, res.timings.read - parse);
+        _metrics._record(endpoint.key, res.timings, _steadyNs() - start);
+
+        const int code = res.code;
+        const string& errorRcvd = res.body;
+
+        if (code != 200) { kc::_throwException(_apiErrorOf(errorRcvd, code)); };
     };
 
 }; // namespace kitepp
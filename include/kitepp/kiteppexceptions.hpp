@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <utility>
 
 #include "kiteppexception.hpp"
@@ -211,33 +214,98 @@ class libException : public std::exception {
     string _message = "";
 };
 
-// throw exception wrt string passed. Throws libException if string doesn't match with anything.
+// errors
+
+/// types of errors returned by REST API, from `error_type` of error responses
+enum class errorType : uint8_t
+{
+    NONE, // not an error
+    TOKEN,
+    USER,
+    ORDER,
+    INPUT,
+    NETWORK,
+    DATA,
+    GENERAL,
+    PERMISSION,
+    NO_EXCEPTION, // REST API didn't return an `error_type`
+    UNKNOWN,      // REST API returned an `error_type` this library doesn't know
+};
 
-inline void _throwException(const string& excpStr, int code, const string& msg) {
+// error type of each exception string sent by API
+// clang-format off
+constexpr std::array<std::pair<std::string_view, errorType>, 9> _errorTypes = {{
+    { "TokenException", errorType::TOKEN },
+    { "UserException", errorType::USER },
+    { "OrderException", errorType::ORDER },
+    { "InputException", errorType::INPUT },
+    { "NetworkException", errorType::NETWORK },
+    { "DataException", errorType::DATA },
+    { "GeneralException", errorType::GENERAL },
+    { "PermissionException", errorType::PERMISSION },
+    { "NoException", errorType::NO_EXCEPTION }, // when REST API doesn't return any exception
+}};
+// clang-format on
+
+inline errorType _errorTypeOf(std::string_view excpStr) {
+
+    for (const auto& type : _errorTypes) {
+        if (type.first == excpStr) { return type.second; };
+    };
+
+    return errorType::UNKNOWN;
+};
+
+/// error returned by REST API. Returned by the `try` variants of calls instead of being thrown
+struct apiError {
+
+    errorType type = errorType::NONE;
+    int code = 0; // HTTP status code
+    string message;
+
+    explicit operator bool() const { return type != errorType::NONE; };
+};
+
+/**
+ * @brief result of a `try` call: the value on success, the error otherwise
+ *
+ * @tparam T
+ */
+template <typename T> struct callResult {
+
+    T value {};
+    apiError error;
+
+    bool ok() const { return !error; };
+
+    explicit operator bool() const { return ok(); };
+};
 
-    // exception strings sent by API
-
-    static const string tokenExcpStr = "TokenException";
-    static const string userExcpStr = "UserException";
-    static const string orderExcpStr = "OrderException";
-    static const string inputExcpStr = "InputException";
-    static const string networkExcpStr = "NetworkException";
-    static const string dataExcpStr = "DataException";
-    static const string generalExcpStr = "GeneralException";
-    static const string permissionExcpStr = "PermissionException";
-    static const string noExcpStr = "NoException"; // when REST API doesn't return any exception
-
-    if (excpStr == tokenExcpStr) { throw tokenException(code, msg); };
-    if (excpStr == userExcpStr) { throw userException(code, msg); };
-    if (excpStr == orderExcpStr) { throw orderException(code, msg); };
-    if (excpStr == inputExcpStr) { throw inputException(code, msg); };
-    if (excpStr == networkExcpStr) { throw networkException(code, msg); };
-    if (excpStr == dataExcpStr) { throw dataException(code, msg); };
-    if (excpStr == generalExcpStr) { throw generalException(code, msg); };
-    if (excpStr == permissionExcpStr) { throw permissionException(code, msg); };
-    if (excpStr == noExcpStr) { throw noException(code, msg); };
+// throws exception corresponding to the type of err. Throws libException if the type isn't known
+
+inline void _throwException(const apiError& err) {
+
+    switch (err.type) {
+        case errorType::TOKEN: throw tokenException(err.code, err.message);
+        case errorType::USER: throw userException(err.code, err.message);
+        case errorType::ORDER: throw orderException(err.code, err.message);
+        case errorType::INPUT: throw inputException(err.code, err.message);
+        case errorType::NETWORK: throw networkException(err.code, err.message);
+        case errorType::DATA: throw dataException(err.code, err.message);
+        case errorType::GENERAL: throw generalException(err.code, err.message);
+        case errorType::PERMISSION: throw permissionException(err.code, err.message);
+        case errorType::NO_EXCEPTION: throw noException(err.code, err.message);
+        case errorType::NONE:
+        case errorType::UNKNOWN: break;
+    };
 
     throw libException("Unknown exception was thrown by REST API");
 };
 
+// throw exception wrt string passed. Throws libException if string doesn't match with anything.
+
+inline void _throwException(const string& excpStr, int code, const string& msg) {
+    _throwException(apiError { _errorTypeOf(excpStr), code, msg });
+};
+
 } // namespace kiteconnect
\ No newline at end of file
@@ -200,6 +200,13 @@ class kiteWS {
      */
     void run() { _hub.run(); };
 
+    /**
+     * @brief get the event loop the client runs on, e.g. for running an `asyncClient` on it (see uwseventloop.hpp)
+     *
+     * @return uS::Loop*
+     */
+    uS::Loop* getLoop() { return _hub.getLoop(); };
+
     /**
      * @brief Stop the client. Closes the connection if connected. Should be the last method to be called.
      *
@@ -0,0 +1,309 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has the latency metrics `kite` records for every REST request, broken down by endpoint and by phase
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "config.hpp"
+#include "kiteppexceptions.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+// steady clock time in nanoseconds
+inline int64_t _steadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+};
+
+/// time spent in each phase of a request, in nanoseconds. Phases a transport can't tell apart are left at zero
+struct requestTimings {
+
+    int64_t wait = 0;      // waiting for the connection to be free
+    int64_t connect = 0;   // DNS lookup and TCP connect, if a connection had to be opened
+    int64_t TLS = 0;       // TLS handshake, if a connection had to be opened
+    int64_t write = 0;     // writing the request
+    int64_t firstByte = 0; // from the request being written to the first byte of the response
+    int64_t read = 0;      // reading the rest of the response
+    int64_t parse = 0;     // parsing the response
+};
+
+/// phases of a request
+enum class requestPhase : size_t
+{
+    WAIT,
+    CONNECT,
+    TLS,
+    WRITE,
+    FIRST_BYTE,
+    READ,
+    PARSE,
+    TOTAL,
+};
+
+// clang-format off
+constexpr std::array<std::string_view, 8> _phaseNames = {
+    "wait", "connect", "tls", "write", "first byte", "read", "parse", "total"
+};
+// clang-format on
+
+/**
+ * @brief Lock-free histogram of latencies. Buckets are log-linear (8 per power of two), so percentiles are accurate to
+ * within ~12%
+ *
+ */
+class latencyHistogram {
+
+  public:
+    // methods
+
+    /**
+     * @brief record a latency
+     *
+     * @param ns nanoseconds
+     */
+    void record(int64_t ns) {
+
+        const uint64_t val = (ns > 0) ? static_cast<uint64_t>(ns) : 0;
+        _buckets[_bucket(val)].fetch_add(1, std::memory_order_relaxed);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        _sum.fetch_add(val, std::memory_order_relaxed);
+
+        uint64_t max = _max.load(std::memory_order_relaxed);
+        while (val > max && !_max.compare_exchange_weak(max, val, std::memory_order_relaxed)) {};
+    };
+
+    /**
+     * @brief get number of latencies recorded
+     *
+     * @return uint64_t
+     */
+    uint64_t getCount() const { return _count.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief get mean latency in nanoseconds
+     *
+     * @return double
+     */
+    double getMean() const {
+
+        const uint64_t count = getCount();
+        return (count == 0) ? 0.0 : static_cast<double>(_sum.load(std::memory_order_relaxed)) / count;
+    };
+
+    /**
+     * @brief get maximum latency in nanoseconds
+     *
+     * @return uint64_t
+     */
+    uint64_t getMax() const { return _max.load(std::memory_order_relaxed); };
+
+    /**
+     * @brief get a percentile of latencies in nanoseconds
+     *
+     * @param pct percentile (0-100)
+     *
+     * @return uint64_t upper bound of the bucket the percentile falls in
+     */
+    uint64_t getPercentile(double pct) const {
+
+        const uint64_t count = getCount();
+        if (count == 0) { return 0; };
+
+        const auto rank = static_cast<uint64_t>(std::max(1.0, pct / 100.0 * static_cast<double>(count) + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < _BUCKETS; i++) {
+            seen += _buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) { return std::min(_upperBound(i), getMax()); };
+        };
+
+        return getMax();
+    };
+
+    /**
+     * @brief clear recorded latencies. Latencies recorded concurrently may be partly lost
+     *
+     */
+    void reset() {
+
+        for (auto& bucket : _buckets) { bucket.store(0, std::memory_order_relaxed); };
+        _count.store(0, std::memory_order_relaxed);
+        _sum.store(0, std::memory_order_relaxed);
+        _max.store(0, std::memory_order_relaxed);
+    };
+
+  private:
+    // member variables
+
+    static constexpr size_t _SUB = 8; // buckets per power of two
+    static constexpr size_t _BUCKETS = 64 * _SUB;
+
+    std::array<std::atomic<uint64_t>, _BUCKETS> _buckets {};
+    std::atomic<uint64_t> _count { 0 };
+    std::atomic<uint64_t> _sum { 0 };
+    std::atomic<uint64_t> _max { 0 };
+
+    // methods
+
+    static size_t _bucket(uint64_t val) {
+
+        if (val < _SUB) { return static_cast<size_t>(val); };
+        const size_t exp = 63 - static_cast<size_t>(__builtin_clzll(val));
+        const size_t sub = static_cast<size_t>(val >> (exp - 3)) & (_SUB - 1);
+        return (exp - 2) * _SUB + sub;
+    };
+
+    static uint64_t _upperBound(size_t bucket) {
+
+        if (bucket < _SUB) { return bucket; };
+        const size_t exp = bucket / _SUB + 2;
+        const uint64_t sub = bucket % _SUB;
+        return ((_SUB + sub + 1) << (exp - 3)) - 1;
+    };
+};
+
+/**
+ * @brief Latencies of REST requests by endpoint (keys of `kite::_endpoints`, e.g. `order.place`) and phase.
+ *
+ * The set of endpoints is fixed when the object is constructed, so recording only touches atomics. Requests whose
+ * endpoint isn't known are recorded under `other`.
+ */
+class restMetrics {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new restMetrics object
+     *
+     * @param endpoints keys of the endpoints
+     */
+    explicit restMetrics(const std::vector<string>& endpoints) {
+
+        for (const auto& endpoint : endpoints) { _endpoints.emplace(endpoint, std::make_unique<_histograms>()); };
+        _endpoints.emplace("other", std::make_unique<_histograms>());
+    };
+
+    // methods
+
+    /**
+     * @brief get the histogram of a phase of an endpoint
+     *
+     * @param endpoint key of the endpoint
+     * @param phase
+     *
+     * @return const latencyHistogram&
+     */
+    const latencyHistogram& get(const string& endpoint, requestPhase phase) const {
+
+        auto it = _endpoints.find(endpoint);
+        if (it == _endpoints.end()) { throw libException(FMT("Unknown endpoint {0} (restMetrics)", endpoint)); };
+
+        return (*it->second)[static_cast<size_t>(phase)];
+    };
+
+    /**
+     * @brief get keys of endpoints that have been requested
+     *
+     * @return std::vector<string>
+     */
+    std::vector<string> getEndpoints() const {
+
+        std::vector<string> endpoints;
+        for (const auto& endpoint : _endpoints) {
+            if ((*endpoint.second)[static_cast<size_t>(requestPhase::TOTAL)].getCount() > 0) {
+                endpoints.push_back(endpoint.first);
+            };
+        };
+        return endpoints;
+    };
+
+    /**
+     * @brief dump metrics of requested endpoints as text. Latencies are in microseconds
+     *
+     * @return string
+     */
+    string dump() const {
+
+        string out = FMT("{:<28}{:<12}{:>10}{:>12}{:>12}{:>12}{:>12}{:>12}\n", "endpoint", "phase", "count", "mean",
+            "p50", "p90", "p99", "max");
+        for (const auto& endpoint : _endpoints) {
+
+            if ((*endpoint.second)[static_cast<size_t>(requestPhase::TOTAL)].getCount() == 0) { continue; };
+            for (size_t i = 0; i < _phaseNames.size(); i++) {
+
+                const latencyHistogram& hist = (*endpoint.second)[i];
+                out += FMT("{:<28}{:<12}{:>10}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}\n", endpoint.first,
+                    _phaseNames[i], hist.getCount(), hist.getMean() / 1000.0, hist.getPercentile(50) / 1000.0,
+                    hist.getPercentile(90) / 1000.0, hist.getPercentile(99) / 1000.0, hist.getMax() / 1000.0);
+            };
+        };
+
+        return out;
+    };
+
+    /**
+     * @brief clear all metrics
+     *
+     */
+    void reset() {
+        for (auto& endpoint : _endpoints) {
+            for (auto& hist : *endpoint.second) { hist.reset(); };
+        };
+    };
+
+    // records a request. Used by kite
+    void _record(std::string_view endpoint, const requestTimings& timings, int64_t total) {
+
+        auto it = _endpoints.find(endpoint);
+        if (it == _endpoints.end()) { it = _endpoints.find(std::string_view("other")); };
+        _histograms& hists = *it->second;
+
+        hists[static_cast<size_t>(requestPhase::WAIT)].record(timings.wait);
+        hists[static_cast<size_t>(requestPhase::CONNECT)].record(timings.connect);
+        hists[static_cast<size_t>(requestPhase::TLS)].record(timings.TLS);
+        hists[static_cast<size_t>(requestPhase::WRITE)].record(timings.write);
+        hists[static_cast<size_t>(requestPhase::FIRST_BYTE)].record(timings.firstByte);
+        hists[static_cast<size_t>(requestPhase::READ)].record(timings.read);
+        hists[static_cast<size_t>(requestPhase::PARSE)].record(timings.parse);
+        hists[static_cast<size_t>(requestPhase::TOTAL)].record(total);
+    };
+
+  private:
+    using _histograms = std::array<latencyHistogram, _phaseNames.size()>;
+
+    // member variables
+
+    // std::less<> allows lookups by string_view. Never modified after construction, so lookups need no lock
+    std::map<string, std::unique_ptr<_histograms>, std::less<>> _endpoints;
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,240 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "config.hpp"
+#include "kite.hpp"
+#include "preparedorder.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/**
+ * @brief Coalesces rapid modifications of the same order.
+ *
+ * Only one modify per order ID is in flight at a time. Modifications made while one is in flight wait for it to return;
+ * a newer one replaces the one that's waiting, so only the latest state of the order is sent once the in-flight modify
+ * returns. Params that the newer modification leaves unset (empty strings, NaN prices and zero quantities) are taken
+ * from the one it replaces.
+ *
+ * Every call blocks until the modify that carried its update returns and gets that modify's order ID (or exception).
+ * Modifications of different orders don't wait for each other.
+ *
+ * `modifyCoalescer` is opt-in: calls made on `kite` directly aren't coalesced. The `kite` object must outlive the
+ * coalescer.
+ */
+class modifyCoalescer {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new modifyCoalescer object
+     *
+     * @param Kite kite object used for sending requests
+     */
+    explicit modifyCoalescer(kite& Kite): _kite(Kite) {};
+
+    // methods
+
+    /**
+     * @brief modify an order. Same as `kite::modifyOrder()` but coalesced
+     *
+     * @param variety
+     * @param ordID order ID
+     * @param parentOrdID parent order ID
+     * @param quantity
+     * @param price
+     * @param ordType order type
+     * @param trigPrice trigger price
+     * @param validity
+     * @param discQuantity disclosed quantity
+     *
+     * @return string order ID
+     */
+    string modifyOrder(const string& variety, const string& ordID, const string& parentOrdID = "",
+        int quantity = DEFAULTINT, double price = DEFAULTDOUBLE, const string& ordType = "",
+        double trigPrice = DEFAULTDOUBLE, const string& validity = "", int discQuantity = DEFAULTINT) {
+
+        auto mod = std::make_shared<_modify>();
+        mod->variety = variety;
+        mod->parentOrdID = parentOrdID;
+        mod->quantity = quantity;
+        mod->price = price;
+        mod->ordType = ordType;
+        mod->trigPrice = trigPrice;
+        mod->validity = validity;
+        mod->discQuantity = discQuantity;
+
+        return _modifyOrder(ordID, mod);
+    };
+
+    /**
+     * @brief modify an order placed with a prepared order. Same as `kite::modifyOrder(const preparedOrder&, ...)` but
+     * coalesced
+     *
+     * @param ord prepared order. Must stay alive until the call returns
+     * @param ordID order ID
+     * @param quantity
+     * @param price
+     * @param trigPrice trigger price
+     *
+     * @return string order ID
+     */
+    string modifyOrder(const preparedOrder& ord, const string& ordID, int quantity, double price = DEFAULTDOUBLE,
+        double trigPrice = DEFAULTDOUBLE) {
+
+        auto mod = std::make_shared<_modify>();
+        mod->prepared = &ord;
+        mod->variety = ord.getVariety();
+        mod->quantity = quantity;
+        mod->price = price;
+        mod->trigPrice = trigPrice;
+
+        return _modifyOrder(ordID, mod);
+    };
+
+  private:
+    // a modification of an order
+    struct _modify {
+
+        const preparedOrder* prepared = nullptr;
+        string variety;
+        string parentOrdID;
+        int quantity = DEFAULTINT;
+        double price = DEFAULTDOUBLE;
+        string ordType;
+        double trigPrice = DEFAULTDOUBLE;
+        string validity;
+        int discQuantity = DEFAULTINT;
+
+        // set when a newer modification replaces this one before it's sent
+        std::shared_ptr<_modify> replacedBy;
+        // set when this modification may be sent
+        bool turn = false;
+        bool done = false;
+        string result;
+        std::exception_ptr error;
+    };
+
+    // modifications of an order
+    struct _order {
+
+        bool inFlight = false;
+        std::shared_ptr<_modify> pending;
+    };
+
+    // member variables
+
+    kite& _kite;
+    std::mutex _mtx;
+    std::condition_variable _cv;
+    std::unordered_map<string, _order> _orders;
+
+    // methods
+
+    string _modifyOrder(const string& ordID, const std::shared_ptr<_modify>& mod) {
+
+        // modification whose request carries this one
+        std::shared_ptr<_modify> carrier = mod;
+        {
+            std::unique_lock<std::mutex> lock(_mtx);
+            _order& ord = _orders[ordID];
+
+            if (!ord.inFlight) {
+
+                ord.inFlight = true;
+                mod->turn = true;
+            } else {
+
+                if (ord.pending) {
+                    _merge(*mod, *ord.pending);
+                    ord.pending->replacedBy = mod;
+                };
+                ord.pending = mod;
+                _cv.notify_all();
+
+                _cv.wait(lock, [&carrier, &mod]() {
+                    while (carrier->replacedBy) { carrier = carrier->replacedBy; };
+                    return (carrier == mod && mod->turn) || carrier->done;
+                });
+            };
+        };
+
+        // the mutex isn't locked while the request is in flight so that newer modifications can replace the pending one
+        if (carrier == mod) { _send(ordID, *mod); };
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        if (carrier->error) { std::rethrow_exception(carrier->error); };
+
+        return carrier->result;
+    };
+
+    void _send(const string& ordID, _modify& mod) {
+
+        string result;
+        std::exception_ptr error;
+        try {
+            result = (mod.prepared != nullptr) ?
+                         _kite.modifyOrder(*mod.prepared, ordID, mod.quantity, mod.price, mod.trigPrice) :
+                         _kite.modifyOrder(mod.variety, ordID, mod.parentOrdID, mod.quantity, mod.price, mod.ordType,
+                             mod.trigPrice, mod.validity, mod.discQuantity);
+        } catch (...) { error = std::current_exception(); };
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        mod.result = std::move(result);
+        mod.error = error;
+        mod.done = true;
+
+        // hand over to the pending modification, if any
+        auto it = _orders.find(ordID);
+        if (it->second.pending) {
+            it->second.pending->turn = true;
+            it->second.pending.reset();
+        } else {
+            _orders.erase(it);
+        };
+        _cv.notify_all();
+    };
+
+    // fills params that newer leaves unset from older
+    static void _merge(_modify& newer, const _modify& older) {
+
+        if (newer.prepared == nullptr && older.prepared == nullptr) {
+
+            if (newer.parentOrdID.empty()) { newer.parentOrdID = older.parentOrdID; };
+            if (newer.ordType.empty()) { newer.ordType = older.ordType; };
+            if (newer.validity.empty()) { newer.validity = older.validity; };
+            if (newer.discQuantity == DEFAULTINT) { newer.discQuantity = older.discQuantity; };
+        };
+        if (newer.quantity == DEFAULTINT) { newer.quantity = older.quantity; };
+        if (std::isnan(newer.price)) { newer.price = older.price; };
+        if (std::isnan(newer.trigPrice)) { newer.trigPrice = older.trigPrice; };
+    };
+};
+
+} // namespace kiteconnect
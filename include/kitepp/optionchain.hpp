@@ -0,0 +1,329 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "instrumentstore.hpp"
+#include "kiteppexceptions.hpp"
+#include "utils.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// option types that can be selected from a chain
+enum class optionType
+{
+    CALL,
+    PUT,
+    BOTH
+};
+
+/// a strike of an option chain. Tokens are 0 and indexes are `instrumentStore::npos` if the strike has no such option
+struct optionStrike {
+
+    double strike = 0.0;
+    int callToken = 0;
+    int putToken = 0;
+    size_t call = instrumentStore::npos; // index of the call in the instrumentStore
+    size_t put = instrumentStore::npos;  // index of the put in the instrumentStore
+};
+
+/**
+ * @brief Option chains of every underlying in an `instrumentStore`.
+ *
+ * Chains are built once per underlying and expiry, with strikes kept in sorted arrays, so ATM, strike window and expiry
+ * queries are binary searches. Underlyings are identified in `exchange:name` (NFO:NIFTY) format and expiries in
+ * `yyyy-mm-dd` format.
+ *
+ * An optionChain is immutable once built. The `instrumentStore` must outlive it.
+ */
+class optionChain {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new optionChain object
+     *
+     * @param store store holding the option contracts (e.g., instruments of NFO)
+     */
+    explicit optionChain(const instrumentStore& store): _store(store) { _build(); };
+
+    // methods
+
+    /**
+     * @brief Get all underlyings that have options
+     *
+     * @return std::vector<string> underlyings in `exchange:name` (NFO:NIFTY) format
+     */
+    std::vector<string> getUnderlyings() const {
+
+        std::vector<string> underlyings;
+        underlyings.reserve(_chains.size());
+        for (const auto& i : _chains) { underlyings.emplace_back(i.first); };
+        std::sort(underlyings.begin(), underlyings.end());
+
+        return underlyings;
+    };
+
+    /**
+     * @brief Get expiries of an underlying
+     *
+     * @param underlying underlying in `exchange:name` (NFO:NIFTY) format
+     *
+     * @return std::vector<string> expiries in ascending order
+     */
+    std::vector<string> getExpiries(const string& underlying) const {
+
+        std::vector<string> expiries;
+        for (const auto& chain : _getChains(underlying)) { expiries.emplace_back(kc::_formatDate(chain.expiryDays)); };
+
+        return expiries;
+    };
+
+    /**
+     * @brief Get the first expiry of an underlying on or after a date
+     *
+     * @param underlying underlying in `exchange:name` (NFO:NIFTY) format
+     * @param date date in `yyyy-mm-dd` format
+     *
+     * @return string expiry or empty string if the underlying has no expiry on or after `date`
+     */
+    string getNearestExpiry(const string& underlying, const string& date) const {
+
+        const auto& chains = _getChains(underlying);
+        auto it = std::lower_bound(chains.begin(), chains.end(), _toDays(date),
+            [](const _chain& chain, int32_t days) { return chain.expiryDays < days; });
+
+        return (it != chains.end()) ? kc::_formatDate(it->expiryDays) : "";
+    };
+
+    /**
+     * @brief Get all strikes of an expiry
+     *
+     * @param underlying underlying in `exchange:name` (NFO:NIFTY) format
+     * @param expiry expiry in `yyyy-mm-dd` format
+     *
+     * @return std::vector<optionStrike> strikes in ascending order
+     */
+    std::vector<optionStrike> getChain(const string& underlying, const string& expiry) const {
+
+        const _chain& chain = _getChain(underlying, expiry);
+        return _slice(chain, 0, chain.strikes.size());
+    };
+
+    /**
+     * @brief Get the strike closest to a price
+     *
+     * @param underlying underlying in `exchange:name` (NFO:NIFTY) format
+     * @param expiry expiry in `yyyy-mm-dd` format
+     * @param spot price of the underlying
+     *
+     * @return double ATM strike
+     */
+    double getATMStrike(const string& underlying, const string& expiry, double spot) const {
+
+        const _chain& chain = _getChain(underlying, expiry);
+        return chain.strikes[_ATMIndex(chain, spot)];
+    };
+
+    /**
+     * @brief Get strikes around the ATM strike
+     *
+     * @param underlying underlying in `exchange:name` (NFO:NIFTY) format
+     * @param expiry expiry in `yyyy-mm-dd` format
+     * @param spot price of the underlying
+     * @param strikes number of strikes to include on each side of the ATM strike
+     *
+     * @return std::vector<optionStrike> up to `2 * strikes + 1` strikes in ascending order
+     */
+    std::vector<optionStrike> getStrikeWindow(
+        const string& underlying, const string& expiry, double spot, size_t strikes) const {
+
+        const _chain& chain = _getChain(underlying, expiry);
+        const size_t atm = _ATMIndex(chain, spot);
+        const size_t begin = (atm > strikes) ? atm - strikes : 0;
+        const size_t end = std::min(chain.strikes.size(), atm + strikes + 1);
+
+        return _slice(chain, begin, end);
+    };
+
+    /**
+     * @brief Get strikes within a price range
+     *
+     * @param underlying underlying in `exchange:name` (NFO:NIFTY) format
+     * @param expiry expiry in `yyyy-mm-dd` format
+     * @param low lowest strike to include
+     * @param high highest strike to include
+     *
+     * @return std::vector<optionStrike> strikes in ascending order
+     */
+    std::vector<optionStrike> getStrikeRange(
+        const string& underlying, const string& expiry, double low, double high) const {
+
+        const _chain& chain = _getChain(underlying, expiry);
+        const auto begin = std::lower_bound(chain.strikes.begin(), chain.strikes.end(), low);
+        const auto end = std::upper_bound(begin, chain.strikes.end(), high);
+
+        return _slice(chain, begin - chain.strikes.begin(), end - chain.strikes.begin());
+    };
+
+    /**
+     * @brief Get instrument tokens of strikes, ready to be passed to `kiteWS::subscribe()` or `kiteWS::setMode()`
+     *
+     * @param strikes
+     * @param type option types to include
+     *
+     * @return std::vector<int>
+     */
+    static std::vector<int> getTokens(const std::vector<optionStrike>& strikes, optionType type = optionType::BOTH) {
+
+        std::vector<int> tokens;
+        tokens.reserve(strikes.size() * ((type == optionType::BOTH) ? 2 : 1));
+        for (const auto& strike : strikes) {
+            if (type != optionType::PUT && strike.callToken != 0) { tokens.push_back(strike.callToken); };
+            if (type != optionType::CALL && strike.putToken != 0) { tokens.push_back(strike.putToken); };
+        };
+
+        return tokens;
+    };
+
+  private:
+    // strikes of an expiry. Every vector is indexed the same way
+    struct _chain {
+
+        int32_t expiryDays = 0;
+        std::vector<double> strikes;
+        std::vector<uint32_t> calls;
+        std::vector<uint32_t> puts;
+    };
+
+    static constexpr uint32_t _none = std::numeric_limits<uint32_t>::max();
+
+    // member variables
+
+    const instrumentStore& _store;
+    std::unordered_map<string, std::vector<_chain>> _chains; // ordered by expiry
+
+    // methods
+
+    void _build() {
+
+        // sorted index is ordered by (name, expiry, strike, instrument type), so strikes arrive in order
+        for (uint32_t idx : _store.sortedIndex()) {
+
+            const std::string_view type = _store.instrumentType(idx);
+            const bool isCall = (type == "CE");
+            if (!isCall && type != "PE") { continue; };
+
+            const int32_t expiryDays = _store.expiryDays(idx);
+            if (expiryDays == instrumentStore::noExpiry) { continue; };
+
+            string underlying(_store.exchange(idx));
+            underlying.push_back(':');
+            underlying.append(_store.name(idx));
+            auto& chains = _chains[underlying];
+            if (chains.empty() || chains.back().expiryDays != expiryDays) {
+                chains.emplace_back();
+                chains.back().expiryDays = expiryDays;
+            };
+
+            _chain& chain = chains.back();
+            const double strike = _store.strikePrice(idx);
+            if (chain.strikes.empty() || chain.strikes.back() != strike) {
+                chain.strikes.push_back(strike);
+                chain.calls.push_back(_none);
+                chain.puts.push_back(_none);
+            };
+            (isCall ? chain.calls : chain.puts).back() = idx;
+        };
+    };
+
+    const std::vector<_chain>& _getChains(const string& underlying) const {
+
+        auto it = _chains.find(underlying);
+        if (it == _chains.end()) { throw libException(FMT("No options found for {0} (optionChain)", underlying)); };
+
+        return it->second;
+    };
+
+    const _chain& _getChain(const string& underlying, const string& expiry) const {
+
+        const auto& chains = _getChains(underlying);
+        const int32_t days = _toDays(expiry);
+        auto it = std::lower_bound(chains.begin(), chains.end(), days,
+            [](const _chain& chain, int32_t expiryDays) { return chain.expiryDays < expiryDays; });
+        if (it == chains.end() || it->expiryDays != days) {
+            throw libException(FMT("No options of {0} expire on {1} (optionChain)", underlying, expiry));
+        };
+
+        return *it;
+    };
+
+    static size_t _ATMIndex(const _chain& chain, double spot) {
+
+        const auto& strikes = chain.strikes;
+        const size_t above = std::lower_bound(strikes.begin(), strikes.end(), spot) - strikes.begin();
+        if (above == 0) { return 0; };
+        if (above == strikes.size()) { return strikes.size() - 1; };
+
+        // ties go to the lower strike
+        return (std::abs(strikes[above] - spot) < std::abs(spot - strikes[above - 1])) ? above : above - 1;
+    };
+
+    std::vector<optionStrike> _slice(const _chain& chain, size_t begin, size_t end) const {
+
+        std::vector<optionStrike> strikes;
+        strikes.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) {
+
+            optionStrike& strike = strikes.emplace_back();
+            strike.strike = chain.strikes[i];
+            if (chain.calls[i] != _none) {
+                strike.call = chain.calls[i];
+                strike.callToken = _store.instrumentToken(chain.calls[i]);
+            };
+            if (chain.puts[i] != _none) {
+                strike.put = chain.puts[i];
+                strike.putToken = _store.instrumentToken(chain.puts[i]);
+            };
+        };
+
+        return strikes;
+    };
+
+    static int32_t _toDays(const string& date) {
+
+        int32_t days = 0;
+        if (!kc::_parseDate(date, days)) { throw libException(FMT("Invalid date {0} (optionChain)", date)); };
+
+        return days;
+    };
+};
+
+} // namespace kiteconnect
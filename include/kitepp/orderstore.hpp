@@ -0,0 +1,429 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "kite.hpp"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// status of an order in `orderStore`
+enum class orderStatus
+{
+    UNKNOWN,
+    REQUESTED, // accepted by the REST API but not seen in a postback or snapshot yet
+    PENDING,   // being validated or sent to the exchange (e.g., `OPEN PENDING`, `AMO REQ RECEIVED`)
+    OPEN,
+    TRIGGER_PENDING,
+    MODIFY_PENDING,
+    CANCEL_PENDING,
+    COMPLETE,
+    CANCELLED,
+    REJECTED
+};
+
+/// state of an order kept by `orderStore`
+struct orderState {
+
+    /**
+     * @brief whether the order is complete, cancelled or rejected
+     *
+     * @return bool
+     */
+    bool isTerminal() const {
+        return status == orderStatus::COMPLETE || status == orderStatus::CANCELLED || status == orderStatus::REJECTED;
+    };
+
+    string orderID;
+    string exchangeOrderID;
+    orderStatus status = orderStatus::UNKNOWN;
+    string statusText; // status as sent by the API
+    string statusMessage;
+
+    string exchange;
+    string tradingSymbol;
+    string transactionType;
+    string orderType;
+    string product;
+    string validity;
+
+    int quantity = 0;
+    int filledQuantity = 0;
+    int pendingQuantity = 0;
+    double price = 0.0;
+    double triggerPrice = 0.0;
+    double averagePrice = 0.0;
+
+    string timestamp;            // exchange (or order) timestamp of the last update applied
+    bool requestPending = false; // a modify or cancel sent through the store hasn't shown up in an update yet
+    size_t updates = 0;          // number of updates applied
+};
+
+/**
+ * @brief In-memory state of the day's orders, kept up to date from order postbacks.
+ *
+ * Seed the store with `sync()`, which applies one `kite::orders()` snapshot, and feed it postbacks received by
+ * `kiteWS`:
+ *
+ *     ws.onOrderUpdate = [&store](kiteWS* ws, const postback& pb) { store.apply(pb); };
+ *
+ * Orders placed, modified or cancelled through the store are recorded as soon as the REST API replies.
+ * `startReconciling()` re-applies a snapshot periodically to pick up postbacks that were missed (e.g., while the
+ * websocket was reconnecting).
+ *
+ * Updates may arrive out of order (a snapshot fetched before a postback may be applied after it), so an update is
+ * ignored if it's older than the state it would replace: if it has an older timestamp, less filled quantity or if the
+ * order has already reached a terminal state that the update doesn't agree with.
+ *
+ * The `kite` object must outlive the store.
+ */
+class orderStore {
+
+  public:
+    // member variables
+
+    /**
+     * @brief Called with exceptions thrown while reconciling in the background
+     */
+    std::function<void(const std::exception& e)> onSyncError;
+
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new orderStore object
+     *
+     * @param Kite kite object used for snapshots and for orders sent through the store
+     */
+    explicit orderStore(kite& Kite): _kite(Kite) {};
+
+    orderStore(const orderStore&) = delete;
+    orderStore& operator=(const orderStore&) = delete;
+
+    ~orderStore() { stopReconciling(); };
+
+    // methods
+
+    /**
+     * @brief apply a `kite::orders()` snapshot
+     */
+    void sync() {
+
+        const std::vector<order> orders = _kite.orders();
+
+        std::unique_lock<std::shared_mutex> lock(_mtx);
+        for (const auto& ord : orders) { _apply(ord); };
+    };
+
+    /**
+     * @brief apply snapshots every `interval` on a background thread until `stopReconciling()` is called or the store
+     * is destroyed. Calls `sync()` once before returning.
+     *
+     * @param interval
+     */
+    void startReconciling(std::chrono::milliseconds interval) {
+
+        stopReconciling();
+        sync();
+
+        _stopReconciler = false;
+        _reconciler = std::thread([this, interval]() {
+            std::unique_lock<std::mutex> lock(_reconcilerMtx);
+            while (!_reconcilerCv.wait_for(lock, interval, [this]() { return _stopReconciler; })) {
+
+                lock.unlock();
+                try {
+                    sync();
+                } catch (const std::exception& e) {
+                    if (onSyncError) { onSyncError(e); };
+                };
+                lock.lock();
+            };
+        });
+    };
+
+    /**
+     * @brief stop the background reconciliation started by `startReconciling()`
+     */
+    void stopReconciling() {
+
+        if (!_reconciler.joinable()) { return; };
+        {
+            std::lock_guard<std::mutex> lock(_reconcilerMtx);
+            _stopReconciler = true;
+        };
+        _reconcilerCv.notify_all();
+        _reconciler.join();
+    };
+
+    /**
+     * @brief apply an order postback
+     *
+     * @param pb
+     */
+    void apply(const postback& pb) {
+
+        std::unique_lock<std::shared_mutex> lock(_mtx);
+        _apply(pb);
+    };
+
+    /**
+     * @brief apply an order returned by the REST API
+     *
+     * @param ord
+     */
+    void apply(const order& ord) {
+
+        std::unique_lock<std::shared_mutex> lock(_mtx);
+        _apply(ord);
+    };
+
+    /**
+     * @brief place an order through `kite::placeOrder()` and record it. Takes the same arguments as `placeOrder()`
+     *
+     * @return string orderID
+     */
+    template <typename... Args> string placeOrder(Args&&... args) {
+
+        string ordID = _kite.placeOrder(std::forward<Args>(args)...);
+
+        std::unique_lock<std::shared_mutex> lock(_mtx);
+        orderState& state = _orders[ordID];
+        if (state.status == orderStatus::UNKNOWN) {
+            state.orderID = ordID;
+            state.status = orderStatus::REQUESTED;
+        };
+
+        return ordID;
+    };
+
+    /**
+     * @brief modify an order through `kite::modifyOrder()` and record it. Takes the same arguments as `modifyOrder()`
+     *
+     * @return string orderID
+     */
+    template <typename... Args> string modifyOrder(Args&&... args) {
+
+        string ordID = _kite.modifyOrder(std::forward<Args>(args)...);
+        _requested(ordID);
+
+        return ordID;
+    };
+
+    /**
+     * @brief cancel an order through `kite::cancelOrder()` and record it. Takes the same arguments as `cancelOrder()`
+     *
+     * @return string orderID
+     */
+    template <typename... Args> string cancelOrder(Args&&... args) {
+
+        string ordID = _kite.cancelOrder(std::forward<Args>(args)...);
+        _requested(ordID);
+
+        return ordID;
+    };
+
+    /**
+     * @brief Get state of an order
+     *
+     * @param ordID order ID
+     * @param state set to state of the order if it's in the store
+     *
+     * @return bool whether the order is in the store
+     */
+    bool get(const string& ordID, orderState& state) const {
+
+        std::shared_lock<std::shared_mutex> lock(_mtx);
+        auto it = _orders.find(ordID);
+        if (it == _orders.end()) { return false; };
+
+        state = it->second;
+        return true;
+    };
+
+    /**
+     * @brief Get status of an order
+     *
+     * @param ordID order ID
+     *
+     * @return orderStatus `orderStatus::UNKNOWN` if the order isn't in the store
+     */
+    orderStatus getStatus(const string& ordID) const {
+
+        std::shared_lock<std::shared_mutex> lock(_mtx);
+        auto it = _orders.find(ordID);
+        return (it == _orders.end()) ? orderStatus::UNKNOWN : it->second.status;
+    };
+
+    /**
+     * @brief Get states of all orders that haven't reached a terminal state
+     *
+     * @return std::vector<orderState>
+     */
+    std::vector<orderState> getOpen() const {
+
+        std::shared_lock<std::shared_mutex> lock(_mtx);
+        std::vector<orderState> open;
+        for (const auto& i : _orders) {
+            if (!i.second.isTerminal()) { open.push_back(i.second); };
+        };
+
+        return open;
+    };
+
+    /**
+     * @brief Get number of orders in the store
+     *
+     * @return size_t
+     */
+    size_t size() const {
+
+        std::shared_lock<std::shared_mutex> lock(_mtx);
+        return _orders.size();
+    };
+
+  private:
+    // member variables
+
+    kite& _kite;
+    mutable std::shared_mutex _mtx;
+    std::unordered_map<string, orderState> _orders;
+
+    std::thread _reconciler;
+    std::mutex _reconcilerMtx;
+    std::condition_variable _reconcilerCv;
+    bool _stopReconciler = false;
+
+    // methods
+
+    static orderStatus _toStatus(std::string_view status) {
+
+        // clang-format off
+        static const std::unordered_map<std::string_view, orderStatus> statuses = {
+            { "PUT ORDER REQ RECEIVED", orderStatus::PENDING },
+            { "VALIDATION PENDING", orderStatus::PENDING },
+            { "OPEN PENDING", orderStatus::PENDING },
+            { "AMO REQ RECEIVED", orderStatus::PENDING },
+            { "OPEN", orderStatus::OPEN },
+            { "UPDATE", orderStatus::OPEN },
+            { "TRIGGER PENDING", orderStatus::TRIGGER_PENDING },
+            { "MODIFY VALIDATION PENDING", orderStatus::MODIFY_PENDING },
+            { "MODIFY PENDING", orderStatus::MODIFY_PENDING },
+            { "MODIFIED", orderStatus::OPEN },
+            { "CANCEL PENDING", orderStatus::CANCEL_PENDING },
+            { "COMPLETE", orderStatus::COMPLETE },
+            { "CANCELLED", orderStatus::CANCELLED },
+            { "REJECTED", orderStatus::REJECTED },
+        };
+        // clang-format on
+
+        auto it = statuses.find(status);
+        return (it == statuses.end()) ? orderStatus::UNKNOWN : it->second;
+    };
+
+    // whether an update with status, filled quantity and timestamp may replace state
+    static bool _isNewer(const orderState& state, orderStatus status, int filledQuantity, const string& timestamp) {
+
+        if (state.updates == 0) { return true; };
+        if (!timestamp.empty() && !state.timestamp.empty() && timestamp < state.timestamp) { return false; };
+        if (filledQuantity < state.filledQuantity) { return false; };
+        if (state.isTerminal() && status != state.status) { return false; };
+
+        return true;
+    };
+
+    // copies members common to order and postback
+    template <typename T> static void _copy(orderState& state, const T& src, orderStatus status) {
+
+        state.orderID = src.orderID;
+        if (!src.exchangeOrderID.empty()) { state.exchangeOrderID = src.exchangeOrderID; };
+        // `UPDATE` postbacks report fills of an open order and don't change its status otherwise
+        const bool isLive = state.status == orderStatus::OPEN || state.status == orderStatus::TRIGGER_PENDING ||
+                            state.status == orderStatus::MODIFY_PENDING || state.status == orderStatus::CANCEL_PENDING;
+        if (src.status != "UPDATE" || !isLive) { state.status = status; };
+        state.statusText = src.status;
+        state.statusMessage = src.statusMessage;
+        state.exchange = src.exchange;
+        state.tradingSymbol = src.tradingSymbol;
+        state.transactionType = src.transactionType;
+        state.orderType = src.orderType;
+        state.product = src.product;
+        state.validity = src.validity;
+        state.quantity = src.quantity;
+        state.filledQuantity = src.filledQuantity;
+        state.price = src.price;
+        state.triggerPrice = src.triggerPrice;
+        state.averagePrice = src.averagePrice;
+        state.requestPending = false;
+        state.updates++;
+    };
+
+    void _apply(const postback& pb) {
+
+        if (pb.orderID.empty()) { return; };
+
+        const orderStatus status = _toStatus(pb.status);
+        const string& timestamp = (pb.exchangeTimestamp.empty()) ? pb.orderTimestamp : pb.exchangeTimestamp;
+        orderState& state = _orders[pb.orderID];
+        if (!_isNewer(state, status, pb.filledQuantity, timestamp)) { return; };
+
+        _copy(state, pb, status);
+        state.pendingQuantity = pb.unfilledQuantity;
+        if (!timestamp.empty()) { state.timestamp = timestamp; };
+    };
+
+    void _apply(const order& ord) {
+
+        if (ord.orderID.empty()) { return; };
+
+        const orderStatus status = _toStatus(ord.status);
+        const string& timestamp =
+            (ord.exchangeUpdateTimestamp.empty()) ? ord.orderTimestamp : ord.exchangeUpdateTimestamp;
+        orderState& state = _orders[ord.orderID];
+        if (!_isNewer(state, status, ord.filledQuantity, timestamp)) { return; };
+
+        _copy(state, ord, status);
+        state.pendingQuantity = ord.pendingQuantity;
+        if (!timestamp.empty()) { state.timestamp = timestamp; };
+    };
+
+    void _requested(const string& ordID) {
+
+        std::unique_lock<std::shared_mutex> lock(_mtx);
+        orderState& state = _orders[ordID];
+        state.orderID = ordID;
+        if (!state.isTerminal()) { state.requestPending = true; };
+    };
+};
+
+} // namespace kiteconnect
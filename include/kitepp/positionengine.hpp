@@ -0,0 +1,442 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "instrumentstore.hpp"
+#include "kite.hpp"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// a position (or holding) marked to market by `positionEngine`
+struct livePosition {
+
+    string exchange;
+    string tradingsymbol;
+    string product;
+    bool isHolding = false;
+    int instrumentToken = 0;
+
+    double quantity = 0.0;
+    double multiplier = 1.0;
+    double lastPrice = 0.0;
+    double PnL = 0.0;
+    double M2M = 0.0; // day change for holdings
+};
+
+/**
+ * @brief Live positions and holdings, marked to market on every tick.
+ *
+ * Seed the engine with `seed()`, then feed it ticks and order postbacks received by `kiteWS`:
+ *
+ *     ws.onTicks = [&engine](kiteWS* ws, const std::vector<tick>& ticks) { engine.apply(ticks); };
+ *     ws.onOrderUpdate = [&engine](kiteWS* ws, const postback& pb) { engine.apply(pb); };
+ *
+ * Fills reported by postbacks are added to the position of their `exchange:tradingsymbol` and product. P&L and M2M
+ * are computed the way Kite computes them:
+ *
+ *     PnL = (sellValue - buyValue) + quantity * lastPrice * multiplier
+ *     M2M = (sellM2MValue - buyM2MValue) + quantity * lastPrice * multiplier
+ *
+ * Positions are kept in columns (one array per field, indexed by position), so a batch of ticks is marked with a
+ * single pass over contiguous arrays. Portfolio P&L and M2M are published through atomics after every update and can
+ * be read from any thread without locking.
+ *
+ * Instruments that appear only in postbacks are resolved to instrument tokens through the `instrumentStore`, if one is
+ * given; otherwise they aren't marked to market until `seed()` is called again. Their multiplier is taken as 1.
+ *
+ * The `kite` object (and `instrumentStore`, if given) must outlive the engine.
+ */
+class positionEngine {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new positionEngine object
+     *
+     * @param Kite kite object used by `seed()`
+     * @param store store used to find instrument tokens of instruments that appear only in postbacks (optional)
+     */
+    explicit positionEngine(kite& Kite, const instrumentStore* store = nullptr): _kite(Kite), _store(store) {};
+
+    // methods
+
+    /**
+     * @brief replace all positions with those returned by the API. Orders are fetched too, so that fills they already
+     * include aren't added again by later postbacks. They're fetched last, so that fills landing while positions are
+     * fetched are found in them and added
+     */
+    void seed() {
+
+        const positions pos = _kite.getPositions();
+        const std::vector<holding> holdings = _kite.holdings();
+        const std::vector<order> orders = _kite.orders();
+        seed(pos, holdings, orders);
+    };
+
+    /**
+     * @brief replace all positions
+     *
+     * @param pos positions returned by `kite::getPositions()`. `net` positions are used
+     * @param holdings holdings returned by `kite::holdings()`
+     * @param orders orders returned by `kite::orders()` after `pos` was fetched. Fills of these orders that `pos`
+     * doesn't include yet, found by comparing day buy and sell quantities, are added to it
+     */
+    void seed(const positions& pos, const std::vector<holding>& holdings, const std::vector<order>& orders = {}) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        _clear();
+
+        std::unordered_map<string, const position*> seeded;
+        for (const auto& p : pos.net) {
+
+            const size_t idx = _slot(p.exchange, p.tradingsymbol, p.product, false, p.instrumentToken);
+            seeded.emplace(_key(p.exchange, p.tradingsymbol, p.product, false), &p);
+            _quantities[idx] = p.quantity;
+            _multipliers[idx] = (p.multiplier != 0.0) ? p.multiplier : 1.0;
+            _lastPrices[idx] = p.lastPrice;
+            _cash[idx] = p.sellValue - p.buyValue;
+            _M2MCash[idx] = p.sellM2MValue - p.buyM2MValue;
+        };
+
+        // a holding is a long position bought at average price and carried in at close price
+        for (const auto& h : holdings) {
+
+            const size_t idx = _slot(h.exchange, h.tradingsymbol, h.product, true, h.instrumentToken);
+            const double quantity = h.quantity + h.t1Quantity;
+            _quantities[idx] = quantity;
+            _lastPrices[idx] = h.lastPrice;
+            _cash[idx] = -h.averagePrice * quantity;
+            _M2MCash[idx] = -h.closePrice * quantity;
+        };
+
+        std::unordered_map<string, _dayFills> dayFills;
+        for (const auto& ord : orders) {
+
+            if (ord.filledQuantity <= 0) { continue; };
+            _fills[ord.orderID] = { ord.filledQuantity, ord.averagePrice };
+
+            _dayFills& day = dayFills[_key(ord.exchange, ord.tradingSymbol, ord.product, false)];
+            day.ord = &ord;
+            const bool sell = ord.transactionType == "SELL";
+            ((sell) ? day.sold : day.bought) += ord.filledQuantity;
+            ((sell) ? day.soldValue : day.boughtValue) += ord.averagePrice * ord.filledQuantity;
+        };
+
+        for (const auto& entry : dayFills) {
+
+            const _dayFills& day = entry.second;
+            auto it = seeded.find(entry.first);
+            const int bought = (it != seeded.end()) ? it->second->dayBuyQuantity : 0;
+            const double boughtValue = (it != seeded.end()) ? it->second->dayBuyPrice * bought : 0.0;
+            const int sold = (it != seeded.end()) ? it->second->daySellQuantity : 0;
+            const double soldValue = (it != seeded.end()) ? it->second->daySellPrice * sold : 0.0;
+            if (day.bought <= bought && day.sold <= sold) { continue; };
+
+            const order& ord = *day.ord;
+            const size_t idx = _slot(ord.exchange, ord.tradingSymbol, ord.product, false, ord.instrumentToken);
+            if (day.bought > bought) { _addFill(idx, 1.0, day.bought - bought, day.boughtValue - boughtValue); };
+            if (day.sold > sold) { _addFill(idx, -1.0, day.sold - sold, day.soldValue - soldValue); };
+        };
+
+        _mark();
+    };
+
+    /**
+     * @brief mark positions to market
+     *
+     * @param ticks
+     */
+    void apply(const std::vector<tick>& ticks) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        for (const auto& t : ticks) {
+
+            auto it = _tokenSlots.find(t.instrumentToken);
+            if (it == _tokenSlots.end()) { continue; };
+            for (size_t idx = it->second; idx != npos; idx = _nextSameToken[idx]) { _lastPrices[idx] = t.lastPrice; };
+        };
+
+        _mark();
+    };
+
+    /**
+     * @brief add fills reported by an order postback
+     *
+     * @param pb
+     */
+    void apply(const postback& pb) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+
+        // postbacks carry cumulative filled quantity and average price of the order
+        auto& last = _fills[pb.orderID];
+        const int filled = pb.filledQuantity - last.first;
+        if (filled <= 0) { return; };
+        const double filledValue = pb.averagePrice * pb.filledQuantity - last.second * last.first;
+        last = { pb.filledQuantity, pb.averagePrice };
+
+        int token = 0;
+        if (_store != nullptr) {
+            const size_t instr = _store->findBySymbol(pb.exchange, pb.tradingSymbol);
+            if (instr != instrumentStore::npos) { token = _store->instrumentToken(instr); };
+        };
+
+        const size_t idx = _slot(pb.exchange, pb.tradingSymbol, pb.product, false, token);
+        _addFill(idx, (pb.transactionType == "SELL") ? -1.0 : 1.0, filled, filledValue);
+
+        _mark();
+    };
+
+    /**
+     * @brief Get P&L of all positions and holdings. Doesn't lock
+     *
+     * @return double
+     */
+    double getPnL() const { return _PnL.load(std::memory_order_acquire); };
+
+    /**
+     * @brief Get M2M of all positions and day change of all holdings. Doesn't lock
+     *
+     * @return double
+     */
+    double getM2M() const { return _M2M.load(std::memory_order_acquire); };
+
+    /**
+     * @brief Get number of positions and holdings
+     *
+     * @return size_t
+     */
+    size_t size() const {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _IDs.size();
+    };
+
+    /**
+     * @brief Get all positions and holdings
+     *
+     * @return std::vector<livePosition>
+     */
+    std::vector<livePosition> getPositions() const {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        std::vector<livePosition> out;
+        out.reserve(_IDs.size());
+        for (size_t i = 0; i < _IDs.size(); i++) { out.push_back(_get(i)); };
+
+        return out;
+    };
+
+    /**
+     * @brief Get a position
+     *
+     * @param exchange
+     * @param tradingsymbol
+     * @param product
+     * @param pos set to the position if it's found
+     * @param isHolding whether to look for a holding instead of a position
+     *
+     * @return bool whether the position was found
+     */
+    bool get(const string& exchange, const string& tradingsymbol, const string& product, livePosition& pos,
+        bool isHolding = false) const {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        auto it = _slots.find(_key(exchange, tradingsymbol, product, isHolding));
+        if (it == _slots.end()) { return false; };
+
+        pos = _get(it->second);
+        return true;
+    };
+
+  private:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    // member variables
+
+    kite& _kite;
+    const instrumentStore* _store;
+    mutable std::mutex _mtx;
+
+    // what a position is
+    struct _positionID {
+        string exchange;
+        string tradingsymbol;
+        string product;
+        bool isHolding = false;
+    };
+
+    // columns, indexed by position
+    std::vector<_positionID> _IDs;
+    std::vector<int32_t> _tokens;
+    std::vector<size_t> _nextSameToken; // next position with the same token or npos
+    std::vector<double> _quantities;
+    std::vector<double> _multipliers;
+    std::vector<double> _lastPrices;
+    std::vector<double> _cash;    // sell value - buy value
+    std::vector<double> _M2MCash; // sell M2M value - buy M2M value
+    std::vector<double> _PnLs;
+    std::vector<double> _M2Ms;
+
+    std::unordered_map<string, size_t> _slots;       // key -> position
+    std::unordered_map<int32_t, size_t> _tokenSlots; // token -> first position with it
+    // order ID -> filled quantity and average price
+    std::unordered_map<string, std::pair<int, double>> _fills;
+
+    // fills of the day of a position, summed over its orders
+    struct _dayFills {
+        const order* ord = nullptr; // one of the orders
+        int bought = 0;
+        double boughtValue = 0.0;
+        int sold = 0;
+        double soldValue = 0.0;
+    };
+
+    std::atomic<double> _PnL { 0.0 };
+    std::atomic<double> _M2M { 0.0 };
+
+    // methods
+
+    static string _key(const string& exchange, const string& tradingsymbol, const string& product, bool isHolding) {
+        return FMT("{0}:{1}:{2}{3}", exchange, tradingsymbol, product, (isHolding) ? ":H" : "");
+    };
+
+    void _clear() {
+
+        _IDs.clear();
+        _tokens.clear();
+        _nextSameToken.clear();
+        _quantities.clear();
+        _multipliers.clear();
+        _lastPrices.clear();
+        _cash.clear();
+        _M2MCash.clear();
+        _PnLs.clear();
+        _M2Ms.clear();
+        _slots.clear();
+        _tokenSlots.clear();
+        _fills.clear();
+    };
+
+    // index of a position, which is added if it doesn't exist
+    size_t _slot(
+        const string& exchange, const string& tradingsymbol, const string& product, bool isHolding, int token) {
+
+        string key = _key(exchange, tradingsymbol, product, isHolding);
+        auto it = _slots.find(key);
+        if (it != _slots.end()) { return it->second; };
+
+        const size_t idx = _IDs.size();
+        _slots.emplace(std::move(key), idx);
+        _IDs.push_back({ exchange, tradingsymbol, product, isHolding });
+        _tokens.push_back(token);
+        _nextSameToken.push_back(npos);
+        _quantities.push_back(0.0);
+        _multipliers.push_back(1.0);
+        _lastPrices.push_back(0.0);
+        _cash.push_back(0.0);
+        _M2MCash.push_back(0.0);
+        _PnLs.push_back(0.0);
+        _M2Ms.push_back(0.0);
+
+        if (token != 0) {
+            auto tokenIt = _tokenSlots.find(token);
+            if (tokenIt == _tokenSlots.end()) {
+                _tokenSlots.emplace(token, idx);
+            } else {
+                _nextSameToken[idx] = tokenIt->second;
+                tokenIt->second = idx;
+            };
+        };
+
+        return idx;
+    };
+
+    // adds a fill of filled quantity worth filledValue. sign is -1 for sells
+    void _addFill(size_t idx, double sign, int filled, double filledValue) {
+
+        _quantities[idx] += sign * filled;
+        _cash[idx] -= sign * filledValue * _multipliers[idx];
+        _M2MCash[idx] -= sign * filledValue * _multipliers[idx];
+        if (_lastPrices[idx] == 0.0) { _lastPrices[idx] = filledValue / filled; };
+    };
+
+    // recomputes P&L and M2M of every position and publishes their totals
+    void _mark() {
+
+        const size_t n = _IDs.size();
+        const double* quantities = _quantities.data();
+        const double* multipliers = _multipliers.data();
+        const double* lastPrices = _lastPrices.data();
+        const double* cash = _cash.data();
+        const double* M2MCash = _M2MCash.data();
+        double* PnLs = _PnLs.data();
+        double* M2Ms = _M2Ms.data();
+
+        // kept free of branches and aliasing so that it's vectorized
+        for (size_t i = 0; i < n; i++) {
+
+            const double value = quantities[i] * lastPrices[i] * multipliers[i];
+            PnLs[i] = cash[i] + value;
+            M2Ms[i] = M2MCash[i] + value;
+        };
+
+        double PnL = 0.0;
+        double M2M = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            PnL += PnLs[i];
+            M2M += M2Ms[i];
+        };
+
+        _PnL.store(PnL, std::memory_order_release);
+        _M2M.store(M2M, std::memory_order_release);
+    };
+
+    livePosition _get(size_t idx) const {
+
+        livePosition pos;
+        pos.exchange = _IDs[idx].exchange;
+        pos.tradingsymbol = _IDs[idx].tradingsymbol;
+        pos.product = _IDs[idx].product;
+        pos.isHolding = _IDs[idx].isHolding;
+        pos.instrumentToken = _tokens[idx];
+        pos.quantity = _quantities[idx];
+        pos.multiplier = _multipliers[idx];
+        pos.lastPrice = _lastPrices[idx];
+        pos.PnL = _PnLs[idx];
+        pos.M2M = _M2Ms[idx];
+
+        return pos;
+    };
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,174 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <string>
+#include <string_view>
+
+#include "config.hpp"
+#include "kiteppexceptions.hpp"
+#include "requestbuilder.hpp"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/**
+ * @brief An order whose fixed fields are encoded once and reused for every order sent with it.
+ *
+ * Exchange, trading symbol, transaction type, product, order type, validity, tag and the variety path are URL-encoded
+ * when the object is constructed. `kite::placeOrder(const preparedOrder&, ...)` and
+ * `kite::modifyOrder(const preparedOrder&, ...)` then only append quantity, price and trigger price to them.
+ *
+ * Prices are rounded to the nearest multiple of the instrument's tick size and sent with as many decimals as the tick
+ * size has (e.g., `1412.95` for a tick size of `0.05`).
+ */
+class preparedOrder {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new preparedOrder object
+     *
+     * @param variety
+     * @param exchange
+     * @param symbol trading symbol
+     * @param txnType transaction type
+     * @param product
+     * @param orderType
+     * @param tickSize tick size of the instrument
+     * @param validity
+     * @param tag
+     *
+     * @throws libException if tick size isn't a positive number
+     */
+    preparedOrder(const string& variety, const string& exchange, const string& symbol, const string& txnType,
+        const string& product, const string& orderType, double tickSize, const string& validity = "",
+        const string& tag = "")
+        : _variety(variety), _tickSize(tickSize) {
+
+        if (!(tickSize > 0.0)) { throw libException(FMT("Invalid tick size {0} (preparedOrder)", tickSize)); };
+        _decimals = _tickDecimals(tickSize);
+
+        _placePath = FMT(_paths[static_cast<size_t>(_path::ORDER_PLACE)], variety);
+
+        _appendParam(_placeParams, "exchange", exchange);
+        _appendParam(_placeParams, "tradingsymbol", symbol);
+        _appendParam(_placeParams, "transaction_type", txnType);
+        _appendParam(_placeParams, "product", product);
+        _appendParam(_placeParams, "order_type", orderType);
+        _appendParam(_placeParams, "validity", validity);
+        _appendParam(_placeParams, "tag", tag);
+
+        _appendParam(_modifyParams, "order_type", orderType);
+        _appendParam(_modifyParams, "validity", validity);
+    };
+
+    /**
+     * @brief Construct a new preparedOrder object for an instrument. Exchange, trading symbol and tick size are taken
+     * from the instrument
+     *
+     * @param instr instrument
+     * @param variety
+     * @param txnType transaction type
+     * @param product
+     * @param orderType
+     * @param validity
+     * @param tag
+     *
+     * @throws libException if tick size of the instrument isn't a positive number
+     */
+    preparedOrder(const instrument& instr, const string& variety, const string& txnType, const string& product,
+        const string& orderType, const string& validity = "", const string& tag = "")
+        : preparedOrder(variety, instr.exchange, instr.tradingsymbol, txnType, product, orderType, instr.tickSize,
+              validity, tag) {};
+
+    // methods
+
+    /**
+     * @brief Get the variety
+     *
+     * @return const string&
+     */
+    const string& getVariety() const { return _variety; };
+
+    /**
+     * @brief Get the tick size
+     *
+     * @return double
+     */
+    double getTickSize() const { return _tickSize; };
+
+    /**
+     * @brief round price to the nearest multiple of tick size
+     *
+     * @param price
+     *
+     * @return double
+     */
+    double roundToTick(double price) const { return std::round(price / _tickSize) * _tickSize; };
+
+  private:
+    friend class kite;
+    friend class asyncClient;
+
+    // member variables
+
+    string _variety;
+    string _placePath;
+    string _placeParams;
+    string _modifyParams;
+    double _tickSize = 0.0;
+    int _decimals = 0;
+
+    // methods
+
+    // number of decimals needed to write multiples of tickSize
+    static int _tickDecimals(double tickSize) {
+
+        double scaled = tickSize;
+        for (int decimals = 0; decimals < 8; decimals++) {
+
+            if (std::abs(scaled - std::round(scaled)) < 1e-6) { return decimals; };
+            scaled *= 10;
+        };
+
+        return 8;
+    };
+
+    static void _appendParam(string& params, std::string_view key, const string& value) {
+
+        if (value.empty()) { return; };
+        if (!params.empty()) { params.push_back('&'); };
+        params.append(key.data(), key.size()).push_back('=');
+        _appendURLEncoded(params, value);
+    };
+
+    // appends quantity, price and trigger price to req
+    void _appendVariable(_requestBuilder& req, int quantity, double price, double trigPrice) const {
+
+        req.param("quantity", quantity);
+        if (!std::isnan(price)) { req.param("price", roundToTick(price), _decimals); };
+        if (!std::isnan(trigPrice)) { req.param("trigger_price", roundToTick(trigPrice), _decimals); };
+    };
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,244 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "kite.hpp"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/**
+ * @brief Coalesces concurrent quote requests into fewer REST calls.
+ *
+ * Quote requests (`getQuote()`, `getOHLC()`, `getLTP()`) that arrive within `window` of each other are merged into a
+ * single deduplicated request. The first caller of a batch waits for the window to elapse (or for the batch to fill
+ * up), sends the request on behalf of everyone and each caller gets back only the symbols it asked for. Requests that
+ * are larger than a single batch bypass batching.
+ *
+ * `quoteBatcher` is opt-in: calls made on `kite` directly aren't batched. The `kite` object must outlive the batcher.
+ */
+class quoteBatcher {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new quoteBatcher object
+     *
+     * @param Kite kite object used for sending requests
+     * @param window time for which the first request of a batch waits for others to join it
+     */
+    explicit quoteBatcher(kite& Kite, std::chrono::microseconds window = std::chrono::milliseconds(5))
+        : _kite(Kite), _window(window) {};
+
+    // methods
+
+    /**
+     * @brief Set the batching window
+     *
+     * @param window
+     */
+    void setWindow(std::chrono::microseconds window) {
+        std::lock_guard<std::mutex> lock(_windowMtx);
+        _window = window;
+    };
+
+    /**
+     * @brief Get the batching window
+     *
+     * @return std::chrono::microseconds
+     */
+    std::chrono::microseconds getWindow() const {
+        std::lock_guard<std::mutex> lock(_windowMtx);
+        return _window;
+    };
+
+    /**
+     * @brief Retrieve quote for list of instruments. Same as `kite::getQuote()` but batched.
+     *
+     * @param symbols vector of trading symbols in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::unordered_map<string, quote>
+     */
+    std::unordered_map<string, quote> getQuote(const std::vector<string>& symbols) {
+        return _get(_quoteLane, symbols, &kite::getQuote);
+    };
+
+    /**
+     * @brief Retrieve OHLC for list of instruments. Same as `kite::getOHLC()` but batched.
+     *
+     * @param symbols vector of trading symbols in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::unordered_map<string, OHLCQuote>
+     */
+    std::unordered_map<string, OHLCQuote> getOHLC(const std::vector<string>& symbols) {
+        return _get(_OHLCLane, symbols, &kite::getOHLC);
+    };
+
+    /**
+     * @brief Retrieve last price for list of instruments. Same as `kite::getLTP()` but batched.
+     *
+     * @param symbols vector of trading symbols in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::unordered_map<string, LTPQuote>
+     */
+    std::unordered_map<string, LTPQuote> getLTP(const std::vector<string>& symbols) {
+        return _get(_LTPLane, symbols, &kite::getLTP);
+    };
+
+  private:
+    // a set of symbols that will be requested together
+    template <typename T> struct _batch {
+
+        std::unordered_set<string> symbols;
+        bool closed = false;
+        bool done = false;
+        std::unordered_map<string, T> result;
+        std::exception_ptr error;
+        std::condition_variable cv;
+    };
+
+    // pending batch of a particular quote endpoint
+    template <typename T> struct _lane {
+
+        explicit _lane(size_t maxsymbols): maxSymbols(maxsymbols) {};
+
+        const size_t maxSymbols;
+        std::mutex mtx;
+        std::condition_variable fullCv;
+        std::shared_ptr<_batch<T>> open;
+    };
+
+    template <typename T> using _fetchFn = std::unordered_map<string, T> (kite::*)(const std::vector<string>&);
+
+    // member variables
+
+    kite& _kite;
+    mutable std::mutex _windowMtx;
+    std::chrono::microseconds _window;
+
+    // maximum number of instruments allowed in a single request by the API
+    _lane<quote> _quoteLane { 500 };
+    _lane<OHLCQuote> _OHLCLane { 1000 };
+    _lane<LTPQuote> _LTPLane { 1000 };
+
+    // methods
+
+    template <typename T>
+    std::unordered_map<string, T> _get(_lane<T>& lane, const std::vector<string>& symbols, _fetchFn<T> fetch) {
+
+        if (symbols.empty()) { return {}; };
+        if (symbols.size() > lane.maxSymbols) { return (_kite.*fetch)(symbols); };
+
+        std::shared_ptr<_batch<T>> batch;
+        bool isLeader = false;
+        {
+            std::unique_lock<std::mutex> lock(lane.mtx);
+
+            // start a new batch if there isn't one or if this request wouldn't fit in the open one
+            if (!lane.open || !_fits(*lane.open, symbols, lane.maxSymbols)) {
+
+                if (lane.open) {
+                    lane.open->closed = true;
+                    lane.fullCv.notify_all();
+                };
+                lane.open = std::make_shared<_batch<T>>();
+                isLeader = true;
+            };
+
+            batch = lane.open;
+            batch->symbols.insert(symbols.begin(), symbols.end());
+            if (batch->symbols.size() >= lane.maxSymbols) {
+                batch->closed = true;
+                lane.fullCv.notify_all();
+            };
+
+            if (isLeader) {
+
+                lane.fullCv.wait_for(lock, getWindow(), [&batch]() { return batch->closed; });
+                batch->closed = true;
+                if (lane.open == batch) { lane.open.reset(); };
+            } else {
+
+                batch->cv.wait(lock, [&batch]() { return batch->done; });
+            };
+        };
+
+        if (isLeader) {
+
+            // the lane isn't locked while the request is in flight so that the next batch can start forming
+            std::unordered_map<string, T> result;
+            std::exception_ptr error;
+            try {
+                result = (_kite.*fetch)({ batch->symbols.begin(), batch->symbols.end() });
+            } catch (...) { error = std::current_exception(); };
+
+            std::lock_guard<std::mutex> lock(lane.mtx);
+            batch->result = std::move(result);
+            batch->error = error;
+            batch->done = true;
+            batch->cv.notify_all();
+        };
+
+        return _select(lane, *batch, symbols);
+    };
+
+    template <typename T> static bool _fits(const _batch<T>& batch, const std::vector<string>& symbols, size_t max) {
+
+        if (batch.closed) { return false; };
+
+        size_t newSymbols = 0;
+        for (const auto& symbol : symbols) {
+            if (batch.symbols.find(symbol) == batch.symbols.end()) { newSymbols++; };
+        };
+
+        return batch.symbols.size() + newSymbols <= max;
+    };
+
+    template <typename T>
+    static std::unordered_map<string, T> _select(
+        _lane<T>& lane, const _batch<T>& batch, const std::vector<string>& symbols) {
+
+        std::lock_guard<std::mutex> lock(lane.mtx);
+        if (batch.error) { std::rethrow_exception(batch.error); };
+
+        std::unordered_map<string, T> quoteMap;
+        for (const auto& symbol : symbols) {
+
+            auto it = batch.result.find(symbol);
+            if (it != batch.result.end()) { quoteMap.emplace(it->first, it->second); };
+        };
+
+        return quoteMap;
+    };
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,288 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "kite.hpp"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// quote endpoints that can be cached by `quoteCache`
+enum class quoteEndpoint
+{
+    QUOTE,
+    OHLC,
+    LTP
+};
+
+/// a cached value along with the time elapsed since it was fetched
+template <typename T> struct cachedQuote {
+
+    T value;
+    std::chrono::milliseconds age { 0 };
+};
+
+/**
+ * @brief In-process TTL cache for quote, OHLC and LTP responses.
+ *
+ * Entries are kept per symbol and are served as long as they are younger than the TTL of their endpoint (or the TTL
+ * set for that particular symbol). Only the symbols that miss the cache are requested from the API. The cache is
+ * sharded by symbol and every shard is guarded by a reader-writer lock, so concurrent lookups don't block each other.
+ *
+ * @attention meant for consumers that can tolerate slightly stale prices. The `kite` object must outlive the cache.
+ */
+class quoteCache {
+
+  public:
+    using clock = std::chrono::steady_clock;
+
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new quoteCache object
+     *
+     * @param Kite kite object used for fetching the missed symbols
+     * @param ttl TTL used for all endpoints unless changed by `setTTL()`
+     */
+    explicit quoteCache(kite& Kite, std::chrono::milliseconds ttl = std::chrono::milliseconds(1000)): _kite(Kite) {
+        _TTLs.fill(ttl);
+    };
+
+    // methods
+
+    /**
+     * @brief Set TTL of an endpoint
+     *
+     * @param endpoint
+     * @param ttl
+     */
+    void setTTL(quoteEndpoint endpoint, std::chrono::milliseconds ttl) {
+        std::unique_lock<std::shared_mutex> lock(_TTLMtx);
+        _TTLs[static_cast<size_t>(endpoint)] = ttl;
+    };
+
+    /**
+     * @brief Set TTL of a symbol for an endpoint. Overrides the TTL of the endpoint.
+     *
+     * @param endpoint
+     * @param symbol trading symbol in `exchange:tradingsymbol` (NSE:INFY) format
+     * @param ttl
+     */
+    void setTTL(quoteEndpoint endpoint, const string& symbol, std::chrono::milliseconds ttl) {
+        std::unique_lock<std::shared_mutex> lock(_TTLMtx);
+        _symbolTTLs[static_cast<size_t>(endpoint)][symbol] = ttl;
+    };
+
+    /**
+     * @brief Get the TTL applicable to a symbol for an endpoint
+     *
+     * @param endpoint
+     * @param symbol trading symbol in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::chrono::milliseconds
+     */
+    std::chrono::milliseconds getTTL(quoteEndpoint endpoint, const string& symbol = "") const {
+
+        std::shared_lock<std::shared_mutex> lock(_TTLMtx);
+        const auto& symbolTTLs = _symbolTTLs[static_cast<size_t>(endpoint)];
+        if (!symbolTTLs.empty()) {
+
+            auto it = symbolTTLs.find(symbol);
+            if (it != symbolTTLs.end()) { return it->second; };
+        };
+
+        return _TTLs[static_cast<size_t>(endpoint)];
+    };
+
+    /**
+     * @brief Retrieve quote for list of instruments, serving fresh entries from cache
+     *
+     * @param symbols vector of trading symbols in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::unordered_map<string, cachedQuote<quote>>
+     */
+    std::unordered_map<string, cachedQuote<quote>> getQuote(const std::vector<string>& symbols) {
+        return _get(_quotes, quoteEndpoint::QUOTE, symbols, &kite::getQuote);
+    };
+
+    /**
+     * @brief Retrieve OHLC for list of instruments, serving fresh entries from cache
+     *
+     * @param symbols vector of trading symbols in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::unordered_map<string, cachedQuote<OHLCQuote>>
+     */
+    std::unordered_map<string, cachedQuote<OHLCQuote>> getOHLC(const std::vector<string>& symbols) {
+        return _get(_OHLCQuotes, quoteEndpoint::OHLC, symbols, &kite::getOHLC);
+    };
+
+    /**
+     * @brief Retrieve last price for list of instruments, serving fresh entries from cache
+     *
+     * @param symbols vector of trading symbols in `exchange:tradingsymbol` (NSE:INFY) format
+     *
+     * @return std::unordered_map<string, cachedQuote<LTPQuote>>
+     */
+    std::unordered_map<string, cachedQuote<LTPQuote>> getLTP(const std::vector<string>& symbols) {
+        return _get(_LTPQuotes, quoteEndpoint::LTP, symbols, &kite::getLTP);
+    };
+
+    /**
+     * @brief Remove cached entries of a symbol from all endpoints
+     *
+     * @param symbol trading symbol in `exchange:tradingsymbol` (NSE:INFY) format
+     */
+    void invalidate(const string& symbol) {
+        _quotes.erase(symbol);
+        _OHLCQuotes.erase(symbol);
+        _LTPQuotes.erase(symbol);
+    };
+
+    /**
+     * @brief Remove all cached entries
+     *
+     */
+    void clear() {
+        _quotes.clear();
+        _OHLCQuotes.clear();
+        _LTPQuotes.clear();
+    };
+
+  private:
+    static constexpr size_t _numShards = 16;
+
+    template <typename T> struct _entry {
+
+        T value;
+        clock::time_point fetchedAt;
+    };
+
+    template <typename T> class _store {
+
+      public:
+        // returns false on a miss or if the entry is older than ttl
+        bool find(const string& symbol, std::chrono::milliseconds ttl, clock::time_point now, cachedQuote<T>& out) {
+
+            _shard& shard = _getShard(symbol);
+            std::shared_lock<std::shared_mutex> lock(shard.mtx);
+
+            auto it = shard.entries.find(symbol);
+            if (it == shard.entries.end()) { return false; };
+
+            auto age = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.fetchedAt);
+            if (age > ttl) { return false; };
+
+            out.value = it->second.value;
+            out.age = age;
+            return true;
+        };
+
+        void insert(const string& symbol, const T& value, clock::time_point fetchedAt) {
+
+            _shard& shard = _getShard(symbol);
+            std::unique_lock<std::shared_mutex> lock(shard.mtx);
+            shard.entries[symbol] = { value, fetchedAt };
+        };
+
+        void erase(const string& symbol) {
+
+            _shard& shard = _getShard(symbol);
+            std::unique_lock<std::shared_mutex> lock(shard.mtx);
+            shard.entries.erase(symbol);
+        };
+
+        void clear() {
+
+            for (auto& shard : _shards) {
+                std::unique_lock<std::shared_mutex> lock(shard.mtx);
+                shard.entries.clear();
+            };
+        };
+
+      private:
+        struct _shard {
+
+            std::shared_mutex mtx;
+            std::unordered_map<string, _entry<T>> entries;
+        };
+
+        std::array<_shard, _numShards> _shards;
+
+        _shard& _getShard(const string& symbol) { return _shards[std::hash<string> {}(symbol) % _numShards]; };
+    };
+
+    template <typename T> using _fetchFn = std::unordered_map<string, T> (kite::*)(const std::vector<string>&);
+
+    // member variables
+
+    kite& _kite;
+
+    mutable std::shared_mutex _TTLMtx;
+    std::array<std::chrono::milliseconds, 3> _TTLs;
+    std::array<std::unordered_map<string, std::chrono::milliseconds>, 3> _symbolTTLs;
+
+    _store<quote> _quotes;
+    _store<OHLCQuote> _OHLCQuotes;
+    _store<LTPQuote> _LTPQuotes;
+
+    // methods
+
+    template <typename T>
+    std::unordered_map<string, cachedQuote<T>> _get(
+        _store<T>& store, quoteEndpoint endpoint, const std::vector<string>& symbols, _fetchFn<T> fetch) {
+
+        std::unordered_map<string, cachedQuote<T>> quoteMap;
+        std::vector<string> missed;
+
+        const auto now = clock::now();
+        for (const auto& symbol : symbols) {
+
+            cachedQuote<T> cached;
+            if (store.find(symbol, getTTL(endpoint, symbol), now, cached)) {
+                quoteMap.emplace(symbol, std::move(cached));
+            } else {
+                missed.emplace_back(symbol);
+            };
+        };
+
+        if (missed.empty()) { return quoteMap; };
+
+        const auto fetchedAt = clock::now();
+        for (auto& i : (_kite.*fetch)(missed)) {
+
+            store.insert(i.first, i.second, fetchedAt);
+            quoteMap[i.first] = { std::move(i.second), std::chrono::milliseconds(0) };
+        };
+
+        return quoteMap;
+    };
+};
+
+} // namespace kiteconnect
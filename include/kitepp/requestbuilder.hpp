@@ -0,0 +1,231 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has the request builder used on the order hot path. Requests are written into per-thread buffers that are
+// reused from one request to the next, so building one doesn't allocate once the buffers have grown
+
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "config.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+// endpoints of the order hot path. Index of _paths
+enum class _path : size_t
+{
+    ORDER_PLACE,
+    ORDER_MODIFY,
+    ORDER_CANCEL,
+    ORDER_CANCEL_BO,
+};
+
+// clang-format off
+constexpr std::array<std::string_view, 4> _paths = {
+
+    "/orders/{}",                          // variety
+    "/orders/{}/{}",                       // variety, order ID
+    "/orders/{}/{}",                       // variety, order ID
+    "/orders/{}/{}?parent_order_id={}",    // variety, order ID, parent order ID
+};
+
+// endpoint keys of _paths, under which requests are recorded in restMetrics
+constexpr std::array<const char*, 4> _pathKeys = {
+
+    "order.place",
+    "order.modify",
+    "order.cancel",
+    "order.cancel.bo",
+};
+// clang-format on
+
+// number of `{}` in a path
+constexpr size_t _pathArgs(std::string_view path) {
+
+    size_t n = 0;
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        if (path[i] == '{' && path[i + 1] == '}') { n++; };
+    };
+
+    return n;
+};
+
+// appends value to out in `application/x-www-form-urlencoded` form
+inline void _appendURLEncoded(string& out, std::string_view value) {
+
+    static constexpr char hex[] = "0123456789ABCDEF";
+
+    for (char c : value) {
+
+        const auto uc = static_cast<unsigned char>(c);
+        if ((uc >= 'a' && uc <= 'z') || (uc >= 'A' && uc <= 'Z') || (uc >= '0' && uc <= '9') || c == '-' || c == '_' ||
+            c == '.' || c == '~') {
+            out.push_back(c);
+        } else if (c == ' ') {
+            out.push_back('+');
+        } else {
+            out.push_back('%');
+            out.push_back(hex[uc >> 4]);
+            out.push_back(hex[uc & 0x0F]);
+        };
+    };
+};
+
+/*
+ Builds the method, path and URL-encoded body of a request. Use local() to get the builder of the calling thread,
+ begin() a request and add body params with param():
+
+    auto& req = _requestBuilder::local().begin<_path::ORDER_PLACE>(_methods::POST, variety);
+    req.param("exchange", exchange).param("quantity", quantity).param("price", price);
+
+ Numbers are formatted with fmt::format_to() (shortest representation that round-trips for doubles) straight into the
+ buffers. A request must be sent before the next one is begun on the same thread.
+*/
+class _requestBuilder {
+
+  public:
+    // methods
+
+    // builder of the calling thread
+    static _requestBuilder& local() {
+        thread_local _requestBuilder builder;
+        return builder;
+    };
+
+    // starts a request, discarding the previous one. args fill the `{}` of the path in order
+    template <_path P, typename... Args> _requestBuilder& begin(_methods mtd, const Args&... args) {
+
+        constexpr std::string_view path = _paths[static_cast<size_t>(P)];
+        static_assert(_pathArgs(path) == sizeof...(Args), "wrong number of path arguments");
+
+        _method = mtd;
+        _endpointKey = _pathKeys[static_cast<size_t>(P)];
+        _path.clear();
+        _body.clear();
+        fmt::format_to(std::back_inserter(_path), path, args...);
+
+        return *this;
+    };
+
+    // starts a request whose path has already been filled in. endpoint is the key it's recorded under in restMetrics
+    _requestBuilder& begin(_methods mtd, std::string_view path, const char* endpoint = "") {
+
+        _method = mtd;
+        _endpointKey = endpoint;
+        _path.assign(path.data(), path.size());
+        _body.clear();
+
+        return *this;
+    };
+
+    // appends params that have already been URL-encoded (`key=value&key=value`)
+    _requestBuilder& encoded(std::string_view params) {
+
+        if (params.empty()) { return *this; };
+        if (!_body.empty()) { _body.push_back('&'); };
+        _body.append(params.data(), params.size());
+        return *this;
+    };
+
+    _requestBuilder& param(std::string_view key, std::string_view value) {
+
+        _key(key);
+        _appendURLEncoded(_body, value);
+        return *this;
+    };
+
+    _requestBuilder& param(std::string_view key, const string& value) { return param(key, std::string_view(value)); };
+
+    _requestBuilder& param(std::string_view key, const char* value) { return param(key, std::string_view(value)); };
+
+    _requestBuilder& param(std::string_view key, int value) {
+
+        _key(key);
+        fmt::format_to(std::back_inserter(_body), "{}", value);
+        return *this;
+    };
+
+    _requestBuilder& param(std::string_view key, double value) {
+
+        _key(key);
+        fmt::format_to(std::back_inserter(_body), "{}", value);
+        return *this;
+    };
+
+    // double with a fixed number of decimals
+    _requestBuilder& param(std::string_view key, double value, int decimals) {
+
+        _key(key);
+        fmt::format_to(std::back_inserter(_body), "{:.{}f}", value, decimals);
+        return *this;
+    };
+
+    // adds the param only if value is set (not empty or NaN)
+    template <typename T> _requestBuilder& paramIfSet(std::string_view key, const T& value) {
+
+        if constexpr (std::is_floating_point<T>::value) {
+            if (std::isnan(value)) { return *this; };
+        } else if constexpr (std::is_same<T, string>::value || std::is_same<T, std::string_view>::value) {
+            if (value.empty()) { return *this; };
+        };
+
+        return param(key, value);
+    };
+
+    _methods method() const { return _method; };
+
+    const string& path() const { return _path; };
+
+    const string& body() const { return _body; };
+
+    const char* endpoint() const { return _endpointKey; };
+
+  private:
+    // constructors and destructor
+
+    _requestBuilder() {
+        _path.reserve(128);
+        _body.reserve(512);
+    };
+
+    // member variables
+
+    _methods _method = _methods::GET;
+    const char* _endpointKey = "";
+    string _path;
+    string _body;
+
+    // methods
+
+    void _key(std::string_view key) {
+
+        if (!_body.empty()) { _body.push_back('&'); };
+        _body.append(key.data(), key.size());
+        _body.push_back('=');
+    };
+};
+
+} // namespace kiteconnect
@@ -22,11 +22,18 @@
 
 #pragma once
 
+#include <cstdint>
 #include <iostream> //debugging
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
+#include "csvparser.hpp"
+#include "fieldtable.hpp"
 #include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
+#include "rapidjson/reader.h"
 #include "rapidjson/rapidjson.h"
 #include "rjutils.hpp"
 #include "utils.hpp"
@@ -45,19 +52,7 @@ struct userProfile {
 
     explicit userProfile(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, userName, "user_name");
-        rju::_getIfExists(val, userShortName, "user_shortname");
-        rju::_getIfExists(val, avatarURL, "avatar_url");
-        rju::_getIfExists(val, userType, "user_type");
-        rju::_getIfExists(val, email, "email");
-        // x rju::_getIfExists(val, phone, "phone");
-        rju::_getIfExists(val, broker, "broker");
-        rju::_getIfExists(val, products, "products");
-        rju::_getIfExists(val, orderTypes, "order_types");
-        rju::_getIfExists(val, exchanges, "exchanges");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string userName;
     string userShortName;
@@ -69,6 +64,20 @@ struct userProfile {
     std::vector<string> products;
     std::vector<string> orderTypes;
     std::vector<string> exchanges;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("user_name", &userProfile::userName),
+        kc::_field("user_shortname", &userProfile::userShortName),
+        kc::_field("avatar_url", &userProfile::avatarURL),
+        kc::_field("user_type", &userProfile::userType),
+        kc::_field("email", &userProfile::email),
+        kc::_field("broker", &userProfile::broker),
+        kc::_field("products", &userProfile::products),
+        kc::_field("order_types", &userProfile::orderTypes),
+        kc::_field("exchanges", &userProfile::exchanges)
+    );
+    // clang-format on
 };
 
 /// tokens received after successfull authentication
@@ -78,16 +87,19 @@ struct userTokens {
 
     explicit userTokens(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, userID, "user_id");
-        rju::_getIfExists(val, accessToken, "access_token");
-        rju::_getIfExists(val, refreshToken, "refresh_token");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string userID;
     string accessToken;
     string refreshToken;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("user_id", &userTokens::userID),
+        kc::_field("access_token", &userTokens::accessToken),
+        kc::_field("refresh_token", &userTokens::refreshToken)
+    );
+    // clang-format on
 };
 
 /// userSession represents the response after a successful authentication.
@@ -97,14 +109,7 @@ struct userSession {
 
     explicit userSession(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        profile.parse(val);
-        tokens.parse(val);
-        rju::_getIfExists(val, apiKey, "api_key");
-        rju::_getIfExists(val, publicToken, "public_token");
-        rju::_getIfExists(val, loginTime, "login_time");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     userProfile profile;
     userTokens tokens;
@@ -112,6 +117,19 @@ struct userSession {
     string apiKey;
     string publicToken;
     string loginTime;
+
+    // profile and tokens are read from the same object as the session
+    // clang-format off
+    static constexpr auto _fields = std::tuple_cat(
+        kc::_subFields(&userSession::profile, userProfile::_fields),
+        kc::_subFields(&userSession::tokens, userTokens::_fields),
+        std::make_tuple(
+            kc::_field("api_key", &userSession::apiKey),
+            kc::_field("public_token", &userSession::publicToken),
+            kc::_field("login_time", &userSession::loginTime)
+        )
+    );
+    // clang-format on
 };
 
 /// availableMargins represents the available margins from the margins response for a single segment.
@@ -121,20 +139,21 @@ struct availableMargins {
 
     explicit availableMargins(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        double debugval = val["cash"].GetDouble();
-
-        rju::_getIfExists(val, adHocMargin, "adhoc_margin");
-        rju::_getIfExists(val, cash, "cash");
-        rju::_getIfExists(val, collateral, "collateral");
-        rju::_getIfExists(val, intradayPayin, "intraday_payin");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     double adHocMargin = 0.0;
     double cash = 0.0;
     double collateral = 0.0;
     double intradayPayin = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("adhoc_margin", &availableMargins::adHocMargin),
+        kc::_field("cash", &availableMargins::cash),
+        kc::_field("collateral", &availableMargins::collateral),
+        kc::_field("intraday_payin", &availableMargins::intradayPayin)
+    );
+    // clang-format on
 };
 
 /// usedMargins represents the used margins from the margins response for a single segment.
@@ -144,17 +163,7 @@ struct usedMargins {
 
     explicit usedMargins(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-        rju::_getIfExists(val, debits, "debits");
-        rju::_getIfExists(val, exposure, "exposure");
-        rju::_getIfExists(val, M2MRealised, "m2m_realised");
-        rju::_getIfExists(val, M2MUnrealised, "m2m_unrealised");
-        rju::_getIfExists(val, optionPremium, "option_premium");
-        rju::_getIfExists(val, payout, "payout");
-        rju::_getIfExists(val, span, "span");
-        rju::_getIfExists(val, holdingSales, "holding_sales");
-        rju::_getIfExists(val, turnover, "turnover");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     double debits = 0.0;
     double exposure = 0.0;
@@ -165,6 +174,20 @@ struct usedMargins {
     double span = 0.0;
     double holdingSales = 0.0;
     double turnover = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("debits", &usedMargins::debits),
+        kc::_field("exposure", &usedMargins::exposure),
+        kc::_field("m2m_realised", &usedMargins::M2MRealised),
+        kc::_field("m2m_unrealised", &usedMargins::M2MUnrealised),
+        kc::_field("option_premium", &usedMargins::optionPremium),
+        kc::_field("payout", &usedMargins::payout),
+        kc::_field("span", &usedMargins::span),
+        kc::_field("holding_sales", &usedMargins::holdingSales),
+        kc::_field("turnover", &usedMargins::turnover)
+    );
+    // clang-format on
 };
 
 /// margins represents the user margins for a segment.
@@ -174,24 +197,21 @@ struct margins {
 
     explicit margins(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, enabled, "enabled");
-        rju::_getIfExists(val, net, "net");
-
-        rj::Value avlVal(rj::kObjectType);
-        rju::_getIfExists(val, avlVal, "available", rju::_RJValueType::Object);
-        rj::Value usedVal(rj::kObjectType);
-        rju::_getIfExists(val, usedVal, "utilised", rju::_RJValueType::Object);
-
-        available.parse(avlVal.GetObject());
-        used.parse(usedVal.GetObject());
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     bool enabled = false;
     double net = 0.0;
     availableMargins available;
     usedMargins used;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("enabled", &margins::enabled),
+        kc::_field("net", &margins::net),
+        kc::_field("available", &margins::available),
+        kc::_field("utilised", &margins::used)
+    );
+    // clang-format on
 };
 
 /// allMargins contains both equity and commodity margins.
@@ -201,19 +221,17 @@ struct allMargins {
 
     explicit allMargins(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rj::Value eqVal(rj::kObjectType);
-        rju::_getIfExists(val, eqVal, "equity", rju::_RJValueType::Object);
-        equity.parse(eqVal.GetObject());
-
-        rj::Value cmVal(rj::kObjectType);
-        rju::_getIfExists(val, cmVal, "commodity", rju::_RJValueType::Object);
-        commodity.parse(cmVal.GetObject());
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     margins equity;
     margins commodity;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("equity", &allMargins::equity),
+        kc::_field("commodity", &allMargins::commodity)
+    );
+    // clang-format on
 };
 
 /// order represents a individual order response.
@@ -223,40 +241,7 @@ struct order {
 
     explicit order(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, accountID, "account_id");
-        rju::_getIfExists(val, placedBy, "placed_by");
-
-        rju::_getIfExists(val, orderID, "order_id");
-        rju::_getIfExists(val, exchangeOrderID, "exchange_order_id");
-        rju::_getIfExists(val, parentOrderID, "parent_order_id");
-        rju::_getIfExists(val, status, "status");
-        rju::_getIfExists(val, statusMessage, "status_message");
-        rju::_getIfExists(val, orderTimestamp, "order_timestamp");
-        rju::_getIfExists(val, exchangeUpdateTimestamp, "exchange_update_timestamp");
-        rju::_getIfExists(val, exchangeTimestamp, "exchange_timestamp");
-        rju::_getIfExists(val, rejectedBy, "rejected_by");
-        rju::_getIfExists(val, variety, "variety");
-
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, tradingSymbol, "tradingsymbol");
-        rju::_getIfExists(val, instrumentToken, "instrument_token");
-
-        rju::_getIfExists(val, orderType, "order_type");
-        rju::_getIfExists(val, transactionType, "transaction_type");
-        rju::_getIfExists(val, validity, "validity");
-        rju::_getIfExists(val, product, "product");
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, disclosedQuantity, "disclosed_quantity");
-        rju::_getIfExists(val, price, "price");
-        rju::_getIfExists(val, triggerPrice, "trigger_price");
-
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, filledQuantity, "filled_quantity");
-        rju::_getIfExists(val, pendingQuantity, "pending_quantity");
-        rju::_getIfExists(val, cancelledQuantity, "cancelled_quantity");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string accountID;
     string placedBy;
@@ -291,6 +276,38 @@ struct order {
     int filledQuantity = 0;
     int pendingQuantity = 0;
     int cancelledQuantity = 0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("account_id", &order::accountID),
+        kc::_field("placed_by", &order::placedBy),
+        kc::_field("order_id", &order::orderID),
+        kc::_field("exchange_order_id", &order::exchangeOrderID),
+        kc::_field("parent_order_id", &order::parentOrderID),
+        kc::_field("status", &order::status),
+        kc::_field("status_message", &order::statusMessage),
+        kc::_field("order_timestamp", &order::orderTimestamp),
+        kc::_field("exchange_update_timestamp", &order::exchangeUpdateTimestamp),
+        kc::_field("exchange_timestamp", &order::exchangeTimestamp),
+        kc::_field("rejected_by", &order::rejectedBy),
+        kc::_field("variety", &order::variety),
+        kc::_field("exchange", &order::exchange),
+        kc::_field("tradingsymbol", &order::tradingSymbol),
+        kc::_field("instrument_token", &order::instrumentToken),
+        kc::_field("order_type", &order::orderType),
+        kc::_field("transaction_type", &order::transactionType),
+        kc::_field("validity", &order::validity),
+        kc::_field("product", &order::product),
+        kc::_field("quantity", &order::quantity),
+        kc::_field("disclosed_quantity", &order::disclosedQuantity),
+        kc::_field("price", &order::price),
+        kc::_field("trigger_price", &order::triggerPrice),
+        kc::_field("average_price", &order::averagePrice),
+        kc::_field("filled_quantity", &order::filledQuantity),
+        kc::_field("pending_quantity", &order::pendingQuantity),
+        kc::_field("cancelled_quantity", &order::cancelledQuantity)
+    );
+    // clang-format on
 };
 
 /// trade represents a individual order response.
@@ -300,21 +317,7 @@ struct trade {
 
     explicit trade(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, tradeID, "trade_id");
-        rju::_getIfExists(val, product, "product");
-        rju::_getIfExists(val, fillTimestamp, "fill_timestamp");
-        rju::_getIfExists(val, exchangeTimestamp, "exchange_timestamp");
-        rju::_getIfExists(val, exchangeOrderID, "exchange_order_id");
-        rju::_getIfExists(val, orderID, "order_id");
-        rju::_getIfExists(val, transactionType, "transaction_type");
-        rju::_getIfExists(val, tradingSymbol, "tradingsymbol");
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, InstrumentToken, "instrument_token");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     double averagePrice;
     double quantity;
@@ -328,6 +331,23 @@ struct trade {
     string tradingSymbol;
     string exchange;
     int InstrumentToken;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("average_price", &trade::averagePrice),
+        kc::_field("quantity", &trade::quantity),
+        kc::_field("trade_id", &trade::tradeID),
+        kc::_field("product", &trade::product),
+        kc::_field("fill_timestamp", &trade::fillTimestamp),
+        kc::_field("exchange_timestamp", &trade::exchangeTimestamp),
+        kc::_field("exchange_order_id", &trade::exchangeOrderID),
+        kc::_field("order_id", &trade::orderID),
+        kc::_field("transaction_type", &trade::transactionType),
+        kc::_field("tradingsymbol", &trade::tradingSymbol),
+        kc::_field("exchange", &trade::exchange),
+        kc::_field("instrument_token", &trade::InstrumentToken)
+    );
+    // clang-format on
 };
 
 /// GTTParams is the struct user needs to pass to placeGTT() to place a GTT
@@ -352,18 +372,21 @@ struct GTTCondition {
 
     explicit GTTCondition(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, tradingsymbol, "tradingsymbol");
-        rju::_getIfExists(val, lastPrice, "last_price");
-        rju::_getIfExists(val, triggerValues, "trigger_values");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string exchange;
     string tradingsymbol;
     double lastPrice = 0.0;
     std::vector<double> triggerValues;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("exchange", &GTTCondition::exchange),
+        kc::_field("tradingsymbol", &GTTCondition::tradingsymbol),
+        kc::_field("last_price", &GTTCondition::lastPrice),
+        kc::_field("trigger_values", &GTTCondition::triggerValues)
+    );
+    // clang-format on
 };
 
 /// GTT represents a single GTT order.
@@ -375,25 +398,9 @@ struct GTT {
 
     void parse(const rj::Value::Object& val) {
 
-        rju::_getIfExists(val, ID, "id");
-        rju::_getIfExists(val, userID, "user_id");
-        rju::_getIfExists(val, type, "type");
-        rju::_getIfExists(val, createdAt, "created_at");
-        rju::_getIfExists(val, updatedAt, "updated_at");
-        rju::_getIfExists(val, expiresAt, "expires_at");
-        rju::_getIfExists(val, status, "status");
-
-        rj::Value condnVal(rj::kObjectType);
-        rju::_getIfExists(val, condnVal, "condition", rju::_RJValueType::Object);
-        condition.parse(condnVal.GetObject());
-
-        auto it = val.FindMember("orders");
-        if (it == val.MemberEnd()) { throw libException("Expected value wasn't found (GTT)"); };
-        if (!it->value.IsArray()) {
-            throw libException("Expected value's type wasn't the one expected. Expected Array");
+        if ((rju::_parseObject(*this, val) & kc::_fieldBit<GTT>("orders")) == 0) {
+            throw libException("Expected value wasn't found (GTT)");
         };
-
-        for (auto& v : it->value.GetArray()) { orders.emplace_back(v.GetObject()); };
     };
 
     int ID = 0;
@@ -405,6 +412,20 @@ struct GTT {
     string status;
     GTTCondition condition;
     std::vector<order> orders;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("id", &GTT::ID),
+        kc::_field("user_id", &GTT::userID),
+        kc::_field("type", &GTT::type),
+        kc::_field("created_at", &GTT::createdAt),
+        kc::_field("updated_at", &GTT::updatedAt),
+        kc::_field("expires_at", &GTT::expiresAt),
+        kc::_field("status", &GTT::status),
+        kc::_field("condition", &GTT::condition),
+        kc::_field("orders", &GTT::orders)
+    );
+    // clang-format on
 }; // namespace kitepp
 
 /// holding is an individual holdings response.
@@ -414,28 +435,7 @@ struct holding {
 
     explicit holding(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, tradingsymbol, "tradingsymbol");
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, instrumentToken, "instrument_token");
-        rju::_getIfExists(val, ISIN, "isin");
-        rju::_getIfExists(val, product, "product");
-
-        rju::_getIfExists(val, price, "price");
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, t1Quantity, "t1_quantity");
-        rju::_getIfExists(val, realisedQuantity, "realised_quantity");
-        rju::_getIfExists(val, collateralQuantity, "collateral_quantity");
-        rju::_getIfExists(val, collateralType, "collateral_type");
-
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, lastPrice, "last_price");
-        rju::_getIfExists(val, closePrice, "close_price");
-        rju::_getIfExists(val, PnL, "pnl");
-        rju::_getIfExists(val, dayChange, "day_change");
-        rju::_getIfExists(val, dayChangePercentage, "day_change_percentage");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string tradingsymbol;
     string exchange;
@@ -456,6 +456,28 @@ struct holding {
     double PnL = 0.0;
     double dayChange = 0.0;
     double dayChangePercentage = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("tradingsymbol", &holding::tradingsymbol),
+        kc::_field("exchange", &holding::exchange),
+        kc::_field("instrument_token", &holding::instrumentToken),
+        kc::_field("isin", &holding::ISIN),
+        kc::_field("product", &holding::product),
+        kc::_field("price", &holding::price),
+        kc::_field("quantity", &holding::quantity),
+        kc::_field("t1_quantity", &holding::t1Quantity),
+        kc::_field("realised_quantity", &holding::realisedQuantity),
+        kc::_field("collateral_quantity", &holding::collateralQuantity),
+        kc::_field("collateral_type", &holding::collateralType),
+        kc::_field("average_price", &holding::averagePrice),
+        kc::_field("last_price", &holding::lastPrice),
+        kc::_field("close_price", &holding::closePrice),
+        kc::_field("pnl", &holding::PnL),
+        kc::_field("day_change", &holding::dayChange),
+        kc::_field("day_change_percentage", &holding::dayChangePercentage)
+    );
+    // clang-format on
 };
 
 /// position represents an individual position response.
@@ -465,44 +487,7 @@ struct position {
 
     explicit position(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, tradingsymbol, "tradingsymbol");
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, instrumentToken, "instrument_token");
-        rju::_getIfExists(val, product, "product");
-
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, overnightQuantity, "overnight_quantity");
-        rju::_getIfExists(val, multiplier, "multiplier");
-
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, closePrice, "close_price");
-        rju::_getIfExists(val, lastPrice, "last_price");
-        rju::_getIfExists(val, value, "value");
-        rju::_getIfExists(val, PnL, "pnl");
-        rju::_getIfExists(val, M2M, "m2m");
-        rju::_getIfExists(val, unrealised, "unrealised");
-        rju::_getIfExists(val, realised, "realised");
-
-        rju::_getIfExists(val, buyQuantity, "buy_quantity");
-        rju::_getIfExists(val, buyPrice, "buy_price");
-        rju::_getIfExists(val, buyValue, "buy_value");
-        rju::_getIfExists(val, buyM2MValue, "buy_m2m");
-
-        rju::_getIfExists(val, sellQuantity, "sell_quantity");
-        rju::_getIfExists(val, sellPrice, "sell_price");
-        rju::_getIfExists(val, sellValue, "sell_value");
-        rju::_getIfExists(val, sellM2MValue, "sell_m2m");
-
-        rju::_getIfExists(val, dayBuyQuantity, "day_buy_quantity");
-        rju::_getIfExists(val, dayBuyPrice, "day_buy_price");
-        rju::_getIfExists(val, dayBuyValue, "day_buy_value");
-
-        rju::_getIfExists(val, daySellQuantity, "day_sell_quantity");
-        rju::_getIfExists(val, daySellPrice, "day_sell_price");
-        rju::_getIfExists(val, daySellValue, "day_sell_value");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string tradingsymbol;
     string exchange;
@@ -539,6 +524,40 @@ struct position {
     int daySellQuantity = 0;
     double daySellPrice = 0.0;
     double daySellValue = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("tradingsymbol", &position::tradingsymbol),
+        kc::_field("exchange", &position::exchange),
+        kc::_field("instrument_token", &position::instrumentToken),
+        kc::_field("product", &position::product),
+        kc::_field("quantity", &position::quantity),
+        kc::_field("overnight_quantity", &position::overnightQuantity),
+        kc::_field("multiplier", &position::multiplier),
+        kc::_field("average_price", &position::averagePrice),
+        kc::_field("close_price", &position::closePrice),
+        kc::_field("last_price", &position::lastPrice),
+        kc::_field("value", &position::value),
+        kc::_field("pnl", &position::PnL),
+        kc::_field("m2m", &position::M2M),
+        kc::_field("unrealised", &position::unrealised),
+        kc::_field("realised", &position::realised),
+        kc::_field("buy_quantity", &position::buyQuantity),
+        kc::_field("buy_price", &position::buyPrice),
+        kc::_field("buy_value", &position::buyValue),
+        kc::_field("buy_m2m", &position::buyM2MValue),
+        kc::_field("sell_quantity", &position::sellQuantity),
+        kc::_field("sell_price", &position::sellPrice),
+        kc::_field("sell_value", &position::sellValue),
+        kc::_field("sell_m2m", &position::sellM2MValue),
+        kc::_field("day_buy_quantity", &position::dayBuyQuantity),
+        kc::_field("day_buy_price", &position::dayBuyPrice),
+        kc::_field("day_buy_value", &position::dayBuyValue),
+        kc::_field("day_sell_quantity", &position::daySellQuantity),
+        kc::_field("day_sell_price", &position::daySellPrice),
+        kc::_field("day_sell_value", &position::daySellValue)
+    );
+    // clang-format on
 };
 
 /// positions represents all positions response.
@@ -548,19 +567,17 @@ struct positions {
 
     explicit positions(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rj::Value netVal(rj::kArrayType);
-        rju::_getIfExists(val, netVal, "net", rju::_RJValueType::Array);
-        for (auto& i : netVal.GetArray()) { net.emplace_back(i.GetObject()); };
-
-        rj::Value dayVal(rj::kArrayType);
-        rju::_getIfExists(val, dayVal, "day", rju::_RJValueType::Array);
-        for (auto& i : dayVal.GetArray()) { day.emplace_back(i.GetObject()); };
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     std::vector<position> net;
     std::vector<position> day;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("net", &positions::net),
+        kc::_field("day", &positions::day)
+    );
+    // clang-format on
 };
 
 /// ohlc strcut
@@ -570,18 +587,21 @@ struct ohlc {
 
     explicit ohlc(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, open, "open");
-        rju::_getIfExists(val, high, "high");
-        rju::_getIfExists(val, low, "low");
-        rju::_getIfExists(val, close, "close");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     double open = 0.0;
     double high = 0.0;
     double low = 0.0;
     double close = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("open", &ohlc::open),
+        kc::_field("high", &ohlc::high),
+        kc::_field("low", &ohlc::low),
+        kc::_field("close", &ohlc::close)
+    );
+    // clang-format on
 };
 
 /// represents market depth
@@ -591,16 +611,19 @@ struct depth {
 
     explicit depth(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, price, "price");
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, orders, "orders");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     double price = 0.0;
     int quantity = 0;
     int orders = 0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("price", &depth::price),
+        kc::_field("quantity", &depth::quantity),
+        kc::_field("orders", &depth::orders)
+    );
+    // clang-format on
 };
 
 /// represents full quote respone
@@ -610,41 +633,7 @@ struct quote {
 
     explicit quote(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, instrumentToken, "instrument_token");
-        rju::_getIfExists(val, timestamp, "timestamp");
-        rju::_getIfExists(val, lastPrice, "last_price");
-        rju::_getIfExists(val, lastQuantity, "last_quantity");
-        rju::_getIfExists(val, lastTradeTime, "last_trade_time");
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, volume, "volume");
-        rju::_getIfExists(val, buyQuantity, "buy_quantity");
-        rju::_getIfExists(val, sellQuantity, "sell_quantity");
-
-        rj::Value ohlcVal(rj::kObjectType);
-        rju::_getIfExists(val, ohlcVal, "ohlc", rju::_RJValueType::Object);
-        OHLC.parse(ohlcVal.GetObject());
-
-        rju::_getIfExists(val, netChange, "net_change");
-        rju::_getIfExists(val, OI, "oi");
-        rju::_getIfExists(val, OIDayHigh, "oi_day_high");
-        rju::_getIfExists(val, OIDayLow, "oi_day_low");
-        rju::_getIfExists(val, lowerCircuitLimit, "lower_circuit_limit");
-        rju::_getIfExists(val, upperCircuitLimit, "upper_circuit_limit");
-
-        rj::Value tmpVal(rj::kObjectType);
-        rju::_getIfExists(val, tmpVal, "depth", rju::_RJValueType::Object);
-        auto depthVal = tmpVal.GetObject();
-
-        rj::Value buyDepthVal(rj::kArrayType);
-        rju::_getIfExists(depthVal, buyDepthVal, "buy", rju::_RJValueType::Array);
-        for (auto& i : buyDepthVal.GetArray()) { marketDepth.buy.emplace_back(i.GetObject()); };
-
-        rj::Value sellDepthVal(rj::kArrayType);
-        rju::_getIfExists(depthVal, sellDepthVal, "sell", rju::_RJValueType::Array);
-        for (auto& i : sellDepthVal.GetArray()) { marketDepth.sell.emplace_back(i.GetObject()); };
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     int instrumentToken = 0;
     string timestamp;
@@ -666,10 +655,40 @@ struct quote {
 
     struct mDepth {
 
+        void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
+
         std::vector<depth> buy;
         std::vector<depth> sell;
 
+        // clang-format off
+        static constexpr auto _fields = std::make_tuple(
+            kc::_field("buy", &mDepth::buy),
+            kc::_field("sell", &mDepth::sell)
+        );
+        // clang-format on
     } marketDepth;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("instrument_token", &quote::instrumentToken),
+        kc::_field("timestamp", &quote::timestamp),
+        kc::_field("last_price", &quote::lastPrice),
+        kc::_field("last_quantity", &quote::lastQuantity),
+        kc::_field("last_trade_time", &quote::lastTradeTime),
+        kc::_field("average_price", &quote::averagePrice),
+        kc::_field("volume", &quote::volume),
+        kc::_field("buy_quantity", &quote::buyQuantity),
+        kc::_field("sell_quantity", &quote::sellQuantity),
+        kc::_field("ohlc", &quote::OHLC),
+        kc::_field("net_change", &quote::netChange),
+        kc::_field("oi", &quote::OI),
+        kc::_field("oi_day_high", &quote::OIDayHigh),
+        kc::_field("oi_day_low", &quote::OIDayLow),
+        kc::_field("lower_circuit_limit", &quote::lowerCircuitLimit),
+        kc::_field("upper_circuit_limit", &quote::upperCircuitLimit),
+        kc::_field("depth", &quote::marketDepth)
+    );
+    // clang-format on
 };
 
 /// represents ohlc quote respone
@@ -679,19 +698,19 @@ struct OHLCQuote {
 
     explicit OHLCQuote(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, instrumentToken, "instrument_token");
-        rju::_getIfExists(val, lastPrice, "last_price");
-
-        rj::Value ohlcVal(rj::kObjectType);
-        rju::_getIfExists(val, ohlcVal, "ohlc", rju::_RJValueType::Object);
-        OHLC.parse(ohlcVal.GetObject());
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     int instrumentToken = 0;
     double lastPrice = 0.0;
     ohlc OHLC;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("instrument_token", &OHLCQuote::instrumentToken),
+        kc::_field("last_price", &OHLCQuote::lastPrice),
+        kc::_field("ohlc", &OHLCQuote::OHLC)
+    );
+    // clang-format on
 };
 
 /// represents ltp quote respone
@@ -701,14 +720,17 @@ struct LTPQuote {
 
     explicit LTPQuote(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, instrumentToken, "instrument_token");
-        rju::_getIfExists(val, lastPrice, "last_price");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     int instrumentToken = 0;
     double lastPrice = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("instrument_token", &LTPQuote::instrumentToken),
+        kc::_field("last_price", &LTPQuote::lastPrice)
+    );
+    // clang-format on
 };
 
 /// represents historical data call reponse
@@ -747,6 +769,150 @@ struct historicalData {
     int OI = 0;
 };
 
+/// historicalCandles represents historical data of an instrument in column-wise form.
+struct historicalCandles {
+
+    historicalCandles() = default;
+
+    explicit historicalCandles(string& json) { parse(json); };
+
+    /// parses a historical data response. Candles are read straight off the JSON text, which is modified in the process
+    void parse(string& json) {
+
+        timestamps.clear();
+        open.clear();
+        high.clear();
+        low.clear();
+        close.clear();
+        volume.clear();
+        OI.clear();
+        reserve(json.size() / 48); // a candle takes ~50 bytes of JSON
+
+        _handler handler(*this);
+        rj::Reader reader;
+        rj::InsituStringStream stream(json.data());
+        if (reader.Parse<rj::kParseInsituFlag>(stream, handler).IsError() || !handler.error.empty()) {
+            throw libException(FMT("Failed to parse historical data ({0}) (historicalCandles)",
+                handler.error.empty() ? rj::GetParseError_En(reader.GetParseErrorCode()) : handler.error));
+        };
+    };
+
+    void reserve(size_t n) {
+
+        timestamps.reserve(n);
+        open.reserve(n);
+        high.reserve(n);
+        low.reserve(n);
+        close.reserve(n);
+        volume.reserve(n);
+        OI.reserve(n);
+    };
+
+    size_t size() const { return timestamps.size(); };
+
+    std::vector<int64_t> timestamps; // nanoseconds since the unix epoch
+    std::vector<double> open;
+    std::vector<double> high;
+    std::vector<double> low;
+    std::vector<double> close;
+    std::vector<int64_t> volume;
+    std::vector<int64_t> OI;
+
+  private:
+    // SAX handler that picks `data.candles` out of the response
+    struct _handler : public rj::BaseReaderHandler<rj::UTF8<>, _handler> {
+
+        explicit _handler(historicalCandles& out): candles(out) {};
+
+        historicalCandles& candles;
+        string error;
+        int depth = 0;
+        bool inData = false;
+        bool inCandles = false;
+        size_t field = 0;
+        std::string_view key;
+
+        bool inCandle() const { return inCandles && depth == 4; };
+
+        bool StartObject() {
+            depth++;
+            if (depth == 2 && key == "data") { inData = true; };
+            return true;
+        };
+
+        bool EndObject(rj::SizeType /*memberCount*/) {
+            if (depth == 2) { inData = false; };
+            depth--;
+            return true;
+        };
+
+        bool Key(const char* str, rj::SizeType length, bool /*copy*/) {
+            key = std::string_view(str, length);
+            return true;
+        };
+
+        bool StartArray() {
+
+            depth++;
+            if (inData && depth == 3 && key == "candles") { inCandles = true; };
+            if (inCandle()) {
+
+                field = 0;
+                candles.timestamps.push_back(0);
+                candles.open.push_back(0.0);
+                candles.high.push_back(0.0);
+                candles.low.push_back(0.0);
+                candles.close.push_back(0.0);
+                candles.volume.push_back(0);
+                candles.OI.push_back(0);
+            };
+            return true;
+        };
+
+        bool EndArray(rj::SizeType /*elementCount*/) {
+
+            if (inCandle() && field < 6) {
+                error = "candle has less than 6 fields";
+                return false;
+            };
+            if (depth == 3) { inCandles = false; };
+            depth--;
+            return true;
+        };
+
+        bool String(const char* str, rj::SizeType length, bool /*copy*/) {
+
+            if (!inCandle()) { return true; };
+            if (field++ != 0 || !kc::_parseISO8601(std::string_view(str, length), candles.timestamps.back())) {
+                error = FMT("unexpected string {0}", std::string_view(str, length));
+                return false;
+            };
+            return true;
+        };
+
+        template <typename T> bool number(T val) {
+
+            if (!inCandle()) { return true; };
+            switch (field++) {
+                case 1: candles.open.back() = static_cast<double>(val); break;
+                case 2: candles.high.back() = static_cast<double>(val); break;
+                case 3: candles.low.back() = static_cast<double>(val); break;
+                case 4: candles.close.back() = static_cast<double>(val); break;
+                case 5: candles.volume.back() = static_cast<int64_t>(val); break;
+                case 6: candles.OI.back() = static_cast<int64_t>(val); break;
+                default: error = "unexpected number"; return false;
+            };
+            return true;
+        };
+
+        bool Int(int val) { return number(val); };
+        bool Uint(unsigned val) { return number(val); };
+        bool Int64(int64_t val) { return number(val); };
+        bool Uint64(uint64_t val) { return number(val); };
+        bool Double(double val) { return number(val); };
+    };
+};
+
 /// MFOrder represents a individual mutualfund order response.
 struct MFOrder {
 
@@ -754,29 +920,7 @@ struct MFOrder {
 
     explicit MFOrder(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, orderID, "order_id");
-        rju::_getIfExists(val, exchangeOrderID, "exchange_order_id");
-        rju::_getIfExists(val, tradingsymbol, "tradingsymbol");
-        rju::_getIfExists(val, status, "status");
-        rju::_getIfExists(val, statusMessage, "status_message");
-        rju::_getIfExists(val, folio, "folio");
-        rju::_getIfExists(val, fund, "fund");
-        rju::_getIfExists(val, orderTimestamp, "order_timestamp");
-        rju::_getIfExists(val, exchangeTimestamp, "exchange_timestamp");
-        rju::_getIfExists(val, settlementID, "settlement_id");
-
-        rju::_getIfExists(val, transactionType, "transaction_type");
-        rju::_getIfExists(val, variety, "variety");
-        rju::_getIfExists(val, purchaseType, "purchase_type");
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, amount, "amount");
-        rju::_getIfExists(val, lastPrice, "last_price");
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, placedBy, "placed_by");
-        rju::_getIfExists(val, tag, "tag");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string orderID;
     string exchangeOrderID;
@@ -798,6 +942,30 @@ struct MFOrder {
     double averagePrice = 0.0;
     string placedBy;
     string tag;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("order_id", &MFOrder::orderID),
+        kc::_field("exchange_order_id", &MFOrder::exchangeOrderID),
+        kc::_field("tradingsymbol", &MFOrder::tradingsymbol),
+        kc::_field("status", &MFOrder::status),
+        kc::_field("status_message", &MFOrder::statusMessage),
+        kc::_field("folio", &MFOrder::folio),
+        kc::_field("fund", &MFOrder::fund),
+        kc::_field("order_timestamp", &MFOrder::orderTimestamp),
+        kc::_field("exchange_timestamp", &MFOrder::exchangeTimestamp),
+        kc::_field("settlement_id", &MFOrder::settlementID),
+        kc::_field("transaction_type", &MFOrder::transactionType),
+        kc::_field("variety", &MFOrder::variety),
+        kc::_field("purchase_type", &MFOrder::purchaseType),
+        kc::_field("quantity", &MFOrder::quantity),
+        kc::_field("amount", &MFOrder::amount),
+        kc::_field("last_price", &MFOrder::lastPrice),
+        kc::_field("average_price", &MFOrder::averagePrice),
+        kc::_field("placed_by", &MFOrder::placedBy),
+        kc::_field("tag", &MFOrder::tag)
+    );
+    // clang-format on
 };
 
 /// MFHolding represents a individual mutualfund holding.
@@ -807,17 +975,7 @@ struct MFHolding {
 
     explicit MFHolding(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, folio, "folio");
-        rju::_getIfExists(val, fund, "fund");
-        rju::_getIfExists(val, tradingsymbol, "tradingsymbol");
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, lastPrice, "last_price");
-        rju::_getIfExists(val, lastPriceDate, "last_price_date");
-        rju::_getIfExists(val, Pnl, "pnl");
-        rju::_getIfExists(val, quantity, "quantity");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string folio;
     string fund;
@@ -827,6 +985,19 @@ struct MFHolding {
     string lastPriceDate;
     double Pnl = 0.0;
     double quantity = 0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("folio", &MFHolding::folio),
+        kc::_field("fund", &MFHolding::fund),
+        kc::_field("tradingsymbol", &MFHolding::tradingsymbol),
+        kc::_field("average_price", &MFHolding::averagePrice),
+        kc::_field("last_price", &MFHolding::lastPrice),
+        kc::_field("last_price_date", &MFHolding::lastPriceDate),
+        kc::_field("pnl", &MFHolding::Pnl),
+        kc::_field("quantity", &MFHolding::quantity)
+    );
+    // clang-format on
 };
 
 /// MFSIP represents a individual mutualfund SIP response.
@@ -836,28 +1007,7 @@ struct MFSIP {
 
     explicit MFSIP(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, ID, "sip_id");
-        rju::_getIfExists(val, tradingsymbol, "tradingsymbol");
-        rju::_getIfExists(val, fundName, "fund");
-        rju::_getIfExists(val, dividendType, "dividend_type");
-        rju::_getIfExists(val, transactionType, "transaction_type");
-
-        rju::_getIfExists(val, status, "status");
-        rju::_getIfExists(val, SIPType, "sip_type");
-        rju::_getIfExists(val, created, "created");
-        rju::_getIfExists(val, frequency, "frequency");
-        rju::_getIfExists(val, instalmentAmount, "instalment_amount");
-        rju::_getIfExists(val, instalments, "instalments");
-        rju::_getIfExists(val, lastInstalment, "last_instalment");
-        rju::_getIfExists(val, pendingInstalments, "pending_instalments");
-        rju::_getIfExists(val, instalmentDay, "instalment_day");
-        rju::_getIfExists(val, completedInstalments, "completed_instalments");
-        rju::_getIfExists(val, nextInstalment, "next_instalment");
-        rju::_getIfExists(val, triggerPrice, "trigger_price");
-        rju::_getIfExists(val, tag, "tag");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string ID;
     string tradingsymbol;
@@ -878,6 +1028,29 @@ struct MFSIP {
     string nextInstalment;
     double triggerPrice = 0.0;
     string tag;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("sip_id", &MFSIP::ID),
+        kc::_field("tradingsymbol", &MFSIP::tradingsymbol),
+        kc::_field("fund", &MFSIP::fundName),
+        kc::_field("dividend_type", &MFSIP::dividendType),
+        kc::_field("transaction_type", &MFSIP::transactionType),
+        kc::_field("status", &MFSIP::status),
+        kc::_field("sip_type", &MFSIP::SIPType),
+        kc::_field("created", &MFSIP::created),
+        kc::_field("frequency", &MFSIP::frequency),
+        kc::_field("instalment_amount", &MFSIP::instalmentAmount),
+        kc::_field("instalments", &MFSIP::instalments),
+        kc::_field("last_instalment", &MFSIP::lastInstalment),
+        kc::_field("pending_instalments", &MFSIP::pendingInstalments),
+        kc::_field("instalment_day", &MFSIP::instalmentDay),
+        kc::_field("completed_instalments", &MFSIP::completedInstalments),
+        kc::_field("next_instalment", &MFSIP::nextInstalment),
+        kc::_field("trigger_price", &MFSIP::triggerPrice),
+        kc::_field("tag", &MFSIP::tag)
+    );
+    // clang-format on
 };
 
 /// orderMarginsParams represents a position in the Margin Calculator API
@@ -903,25 +1076,7 @@ struct orderMargins {
 
     explicit orderMargins(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, type, "type");
-        rju::_getIfExists(val, tradingSymbol, "tradingsymbol");
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, SPAN, "span");
-        rju::_getIfExists(val, exposure, "exposure");
-        rju::_getIfExists(val, optionPremium, "option_premium");
-        rju::_getIfExists(val, additional, "additional");
-        rju::_getIfExists(val, BO, "bo");
-        rju::_getIfExists(val, cash, "cash");
-        rju::_getIfExists(val, VAR, "var");
-
-        rj::Value pnlVal(rj::kObjectType);
-        rju::_getIfExists(val, pnlVal, "pnl", rju::_RJValueType::Object);
-        pnl.parse(pnlVal.GetObject());
-
-        rju::_getIfExists(val, total, "total");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string type;
     string tradingSymbol;
@@ -940,16 +1095,36 @@ struct orderMargins {
 
         explicit PNL(const rj::Value::Object& val) { parse(val); };
 
-        void parse(const rj::Value::Object& val) {
-
-            rju::_getIfExists(val, realised, "realised");
-            rju::_getIfExists(val, unrealised, "unrealised");
-        };
+        void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
         double realised = 0.0;
         double unrealised = 0.0;
+
+        // clang-format off
+        static constexpr auto _fields = std::make_tuple(
+            kc::_field("realised", &PNL::realised),
+            kc::_field("unrealised", &PNL::unrealised)
+        );
+        // clang-format on
     } pnl;
     double total = 0.0;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("type", &orderMargins::type),
+        kc::_field("tradingsymbol", &orderMargins::tradingSymbol),
+        kc::_field("exchange", &orderMargins::exchange),
+        kc::_field("span", &orderMargins::SPAN),
+        kc::_field("exposure", &orderMargins::exposure),
+        kc::_field("option_premium", &orderMargins::optionPremium),
+        kc::_field("additional", &orderMargins::additional),
+        kc::_field("bo", &orderMargins::BO),
+        kc::_field("cash", &orderMargins::cash),
+        kc::_field("var", &orderMargins::VAR),
+        kc::_field("pnl", &orderMargins::pnl),
+        kc::_field("total", &orderMargins::total)
+    );
+    // clang-format on
 };
 
 /// instrument represents individual instrument response.
@@ -959,25 +1134,33 @@ struct instrument {
 
     explicit instrument(const string& val) { parse(val); };
 
+    explicit instrument(const std::vector<std::string_view>& fields) { parse(fields); };
+
     void parse(const string& val) {
 
-        std::vector<string> tokens = kc::_split(val, ',');
-
-        static const auto toInt = [](const string& str) -> int { return (str.empty()) ? 0 : std::stoi(str); };
-        static const auto toDouble = [](const string& str) -> double { return (str.empty()) ? 0.0 : std::stod(str); };
-
-        instrumentToken = toInt(tokens[0]);
-        exchangeToken = toInt(tokens[1]);
-        tradingsymbol = tokens[2];
-        name = tokens[3];
-        lastPrice = toDouble(tokens[4]);
-        expiry = tokens[5];
-        strikePrice = toDouble(tokens[6]);
-        tickSize = toDouble(tokens[7]);
-        lotSize = toDouble(tokens[8]);
-        instrumentType = tokens[9];
-        segment = tokens[10];
-        exchange = tokens[11];
+        kc::_csvParser parser([this](const std::vector<std::string_view>& fields) { parse(fields); }, false);
+        parser.feed(val.data(), val.size());
+        parser.finish();
+    };
+
+    void parse(const std::vector<std::string_view>& fields) {
+
+        if (fields.size() < 12) {
+            throw libException(FMT("Expected 12 fields in instrument row, got {0} (instrument)", fields.size()));
+        };
+
+        instrumentToken = kc::_toInt(fields[0]);
+        exchangeToken = kc::_toInt(fields[1]);
+        tradingsymbol = fields[2];
+        name = fields[3];
+        lastPrice = kc::_toDouble(fields[4]);
+        expiry = fields[5];
+        strikePrice = kc::_toDouble(fields[6]);
+        tickSize = kc::_toDouble(fields[7]);
+        lotSize = kc::_toDouble(fields[8]);
+        instrumentType = fields[9];
+        segment = fields[10];
+        exchange = fields[11];
     };
 
     int instrumentToken = 0;
@@ -1001,28 +1184,37 @@ struct MFInstrument {
 
     explicit MFInstrument(const string& val) { parse(val); };
 
+    explicit MFInstrument(const std::vector<std::string_view>& fields) { parse(fields); };
+
     void parse(const string& val) {
 
-        std::vector<string> tokens = kc::_split(val, ',');
-
-        static const auto toDouble = [](const string& str) -> double { return (str.empty()) ? 0.0 : std::stod(str); };
-
-        tradingsymbol = tokens[0];
-        AMC = tokens[1];
-        name = tokens[2];
-        purchaseAllowed = static_cast<bool>(std::stoi(tokens[3]));
-        redemtpionAllowed = static_cast<bool>(std::stoi(tokens[4]));
-        minimumPurchaseAmount = toDouble(tokens[5]);
-        purchaseAmountMultiplier = toDouble(tokens[6]);
-        minimumAdditionalPurchaseAmount = toDouble(tokens[7]);
-        minimumRedemptionQuantity = toDouble(tokens[8]);
-        redemptionQuantityMultiplier = toDouble(tokens[9]);
-        dividendType = tokens[10];
-        schemeType = tokens[11];
-        plan = tokens[12];
-        settlementType = tokens[13];
-        lastPrice = toDouble(tokens[14]);
-        lastPriceDate = tokens[15];
+        kc::_csvParser parser([this](const std::vector<std::string_view>& fields) { parse(fields); }, false);
+        parser.feed(val.data(), val.size());
+        parser.finish();
+    };
+
+    void parse(const std::vector<std::string_view>& fields) {
+
+        if (fields.size() < 16) {
+            throw libException(FMT("Expected 16 fields in MF instrument row, got {0} (MFInstrument)", fields.size()));
+        };
+
+        tradingsymbol = fields[0];
+        AMC = fields[1];
+        name = fields[2];
+        purchaseAllowed = static_cast<bool>(kc::_toInt(fields[3]));
+        redemtpionAllowed = static_cast<bool>(kc::_toInt(fields[4]));
+        minimumPurchaseAmount = kc::_toDouble(fields[5]);
+        purchaseAmountMultiplier = kc::_toDouble(fields[6]);
+        minimumAdditionalPurchaseAmount = kc::_toDouble(fields[7]);
+        minimumRedemptionQuantity = kc::_toDouble(fields[8]);
+        redemptionQuantityMultiplier = kc::_toDouble(fields[9]);
+        dividendType = fields[10];
+        schemeType = fields[11];
+        plan = fields[12];
+        settlementType = fields[13];
+        lastPrice = kc::_toDouble(fields[14]);
+        lastPriceDate = fields[15];
     };
 
     string tradingsymbol;
@@ -1096,32 +1288,7 @@ struct postback {
 
     explicit postback(const rj::Value::Object& val) { parse(val); };
 
-    void parse(const rj::Value::Object& val) {
-
-        rju::_getIfExists(val, orderID, "order_id");
-        rju::_getIfExists(val, exchangeOrderID, "exchange_order_id");
-        rju::_getIfExists(val, placedBy, "placed_by");
-        rju::_getIfExists(val, status, "status");
-        rju::_getIfExists(val, statusMessage, "status_message");
-
-        rju::_getIfExists(val, tradingSymbol, "tradingsymbol");
-        rju::_getIfExists(val, exchange, "exchange");
-        rju::_getIfExists(val, orderType, "order_type");
-        rju::_getIfExists(val, transactionType, "transaction_type");
-        rju::_getIfExists(val, validity, "validity");
-        rju::_getIfExists(val, product, "product");
-
-        rju::_getIfExists(val, averagePrice, "average_price");
-        rju::_getIfExists(val, price, "price");
-        rju::_getIfExists(val, quantity, "quantity");
-        rju::_getIfExists(val, filledQuantity, "filled_quantity");
-        rju::_getIfExists(val, unfilledQuantity, "unfilled_quantity");
-        rju::_getIfExists(val, triggerPrice, "trigger_price");
-        rju::_getIfExists(val, userID, "user_id");
-        rju::_getIfExists(val, orderTimestamp, "order_timestamp");
-        rju::_getIfExists(val, exchangeTimestamp, "exchange_timestamp");
-        rju::_getIfExists(val, checksum, "checksum");
-    };
+    void parse(const rj::Value::Object& val) { rju::_parseObject(*this, val); };
 
     string orderID;
     string exchangeOrderID;
@@ -1146,6 +1313,32 @@ struct postback {
     string orderTimestamp;
     string exchangeTimestamp;
     string checksum;
+
+    // clang-format off
+    static constexpr auto _fields = std::make_tuple(
+        kc::_field("order_id", &postback::orderID),
+        kc::_field("exchange_order_id", &postback::exchangeOrderID),
+        kc::_field("placed_by", &postback::placedBy),
+        kc::_field("status", &postback::status),
+        kc::_field("status_message", &postback::statusMessage),
+        kc::_field("tradingsymbol", &postback::tradingSymbol),
+        kc::_field("exchange", &postback::exchange),
+        kc::_field("order_type", &postback::orderType),
+        kc::_field("transaction_type", &postback::transactionType),
+        kc::_field("validity", &postback::validity),
+        kc::_field("product", &postback::product),
+        kc::_field("average_price", &postback::averagePrice),
+        kc::_field("price", &postback::price),
+        kc::_field("quantity", &postback::quantity),
+        kc::_field("filled_quantity", &postback::filledQuantity),
+        kc::_field("unfilled_quantity", &postback::unfilledQuantity),
+        kc::_field("trigger_price", &postback::triggerPrice),
+        kc::_field("user_id", &postback::userID),
+        kc::_field("order_timestamp", &postback::orderTimestamp),
+        kc::_field("exchange_timestamp", &postback::exchangeTimestamp),
+        kc::_field("checksum", &postback::checksum)
+    );
+    // clang-format on
 };
 
 } // namespace kiteconnect
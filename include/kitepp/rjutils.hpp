@@ -19,12 +19,23 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "config.hpp"
+#include "kitepp/fieldtable.hpp"
 #include "kitepp/kiteppexceptions.hpp"
 #include "rapidjson/document.h"
+#include "rapidjson/error/en.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 
@@ -49,161 +60,327 @@ inline bool _parse(rj::Document& dom, const string& str) {
     return true;
 };
 
-inline bool _getIfExists(const rj::Value::Object& val, string& out, const char* name) {
+/**
+ * @brief Memory used for parsing responses on a thread.
+ *
+ * Values and the parse stack are allocated from pools backed by buffers the arena keeps. Releasing the arena resets the
+ * pools and, if a parse outgrew a buffer, replaces it with one large enough for it, so a thread that keeps requesting
+ * similar responses stops allocating after the first few. There's one arena per thread and it's used by one document at
+ * a time.
+ */
+class _parseArena {
 
-    auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
+  public:
+    using allocator = rj::MemoryPoolAllocator<>;
+
+    // methods
+
+    // returns arena of the calling thread or nullptr if a document of this thread is already using it
+    static _parseArena* acquire() {
+
+        thread_local _parseArena arena;
+        if (arena._inUse) { return nullptr; };
+        arena._inUse = true;
+
+        return &arena;
+    };
+
+    void release() {
+
+        _values.reset();
+        _stack.reset();
+        _inUse = false;
+    };
+
+    allocator& values() { return *_values.alloc; };
+
+    allocator& stack() { return *_stack.alloc; };
+
+    // size of the first parse stack allocation. Starting with all of the stack buffer avoids reallocations
+    size_t stackCapacity() const { return _stack.size - _headerSize; };
+
+  private:
+    // a pool and the buffer it starts with
+    struct _pool {
 
-        if (it->value.IsString()) {
+        explicit _pool(size_t bytes) { _allocate(bytes); };
 
-            out = it->value.GetString();
-            return true;
+        // drops values of the last document, growing the buffer if they didn't fit in it
+        void reset() {
+
+            const size_t used = alloc->Size();
+            if (used + _headerSize <= size || size >= _maxRetained) {
+
+                alloc->Clear();
+                return;
+            };
+
+            alloc.reset();
+            _allocate(std::min(std::max(size * 2, used + _headerSize), _maxRetained));
         };
 
-        if (it->value.IsNull()) {
+        std::unique_ptr<char[]> buffer;
+        size_t size = 0;
+        std::optional<allocator> alloc;
 
-            out = "";
-            return true;
+      private:
+        void _allocate(size_t bytes) {
+
+            buffer.reset(new char[bytes]);
+            size = bytes;
+            alloc.emplace(buffer.get(), size);
         };
+    };
+
+    // space taken by the chunk header of a pool's buffer
+    static constexpr size_t _headerSize = 64;
+    // buffers don't grow beyond this. Larger responses are parsed using temporary chunks
+    static constexpr size_t _maxRetained = 16 * 1024 * 1024;
 
-        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a string)", name));
+    // member variables
+
+    _pool _values { 64 * 1024 };
+    _pool _stack { 16 * 1024 };
+    bool _inUse = false;
+};
+
+// holds the arena of the calling thread, if it's free, for the lifetime of a document
+struct _arenaLease {
+
+    _arenaLease(): arena(_parseArena::acquire()) {};
+
+    ~_arenaLease() {
+        if (arena != nullptr) { arena->release(); };
     };
 
-    return false;
+    _arenaLease(const _arenaLease&) = delete;
+    _arenaLease& operator=(const _arenaLease&) = delete;
+
+    _parseArena* const arena;
 };
 
-inline bool _getIfExists(const rj::Document& val, string& out, const char* name) {
+using _documentBase = rj::GenericDocument<rj::UTF8<>, rj::MemoryPoolAllocator<>, rj::MemoryPoolAllocator<>>;
 
-    auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
+/**
+ * @brief Document holding a parsed response.
+ *
+ * The response is moved into the document and parsed in-situ, with memory coming from the parse arena of the calling
+ * thread. If the arena is taken (by another document alive on this thread), the document allocates on its own.
+ *
+ * @attention values are valid only while the document is alive. The arena is reset when it's destroyed.
+ */
+class _document: private _arenaLease, public _documentBase {
 
-        if (it->value.IsString()) {
+  public:
+    // constructors and destructor
 
-            out = it->value.GetString();
-            return true;
-        };
+    _document()
+        : _documentBase((arena != nullptr) ? &arena->values() : nullptr,
+              (arena != nullptr) ? arena->stackCapacity() : _ownStackCapacity,
+              (arena != nullptr) ? &arena->stack() : nullptr) {};
+
+    _document(const _document&) = delete;
+    _document& operator=(const _document&) = delete;
+
+    // methods
 
-        if (it->value.IsNull()) {
+    void parse(string&& json) {
 
-            out = "";
-            return true;
+        _json = std::move(json);
+        if (ParseInsitu(&_json[0]).HasParseError()) {
+            throw libException(FMT("Failed to parse json string: {0} (offset {1})",
+                rj::GetParseError_En(GetParseError()), GetErrorOffset()));
         };
+    };
+
+  private:
+    static constexpr size_t _ownStackCapacity = 1024; // rapidjson's default
+
+    // member variables
+
+    string _json; // values point into this
+};
+
+// assigns a JSON value to out. Throws if the value's type isn't the one expected. name is used in the exception
+inline void _assign(const rj::Value& val, string& out, std::string_view name) {
 
-        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a string)", name));
+    if (val.IsString()) {
+
+        out.assign(val.GetString(), val.GetStringLength());
+        return;
     };
 
-    return false;
+    if (val.IsNull()) {
+
+        out.clear();
+        return;
+    };
+
+    throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a string)", name));
 };
 
-inline bool _getIfExists(const rj::Value::Object& val, double& out, const char* name) {
+inline void _assign(const rj::Value& val, double& out, std::string_view name) {
 
-    auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
+    if (val.IsDouble()) {
 
-        if (it->value.IsDouble()) {
+        out = val.GetDouble();
+        return;
+    };
 
-            out = it->value.GetDouble();
-            return true;
-        };
+    // in case returned number doesn't have decimal point. Directly calling GetDouble() will cause error if number
+    // doesn't have decimal
+    if (val.IsInt()) {
 
-        // in case returned number doesn't have decimal point. Directly calling GetDouble() will cause error if number
-        // doesn't have decimal
-        if (it->value.IsInt()) {
+        out = val.GetInt(); //! may lead to precision loss
+        return;
+    };
 
-            out = it->value.GetInt(); //! may lead to precision loss
-            return true;
-        };
+    throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a double)", name));
+};
+
+inline void _assign(const rj::Value& val, int& out, std::string_view name) {
+
+    if (val.IsInt()) {
 
-        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a double)", name));
+        out = val.GetInt();
+        return;
     };
 
-    return false;
+    throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a int)", name));
 };
 
-inline bool _getIfExists(const rj::Value::Object& val, int& out, const char* name) {
+inline void _assign(const rj::Value& val, bool& out, std::string_view name) {
 
-    auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
+    if (val.IsBool()) {
+
+        out = val.GetBool();
+        return;
+    };
+
+    throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a bool)", name));
+};
+
+inline void _assign(const rj::Value& val, std::vector<string>& out, std::string_view name) {
 
-        if (it->value.IsInt()) {
+    if (!val.IsArray()) {
+        throw libException(
+            FMT("Expected value({0})'s type wasn't the one expected (expected an array of strings)", name));
+    };
+
+    for (const auto& v : val.GetArray()) {
 
-            out = it->value.GetInt();
-            return true;
+        if (!v.IsString()) {
+            throw libException(
+                FMT("Expected value({0})'s type wasn't the one expected (expected an array of strings)", name));
         };
+        out.emplace_back(v.GetString(), v.GetStringLength());
+    };
+};
+
+inline void _assign(const rj::Value& val, std::vector<double>& out, std::string_view name) {
 
-        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a int)", name));
+    if (!val.IsArray()) {
+        throw libException(
+            FMT("Expected value({0})'s type wasn't the one expected (expected an array of doubles)", name));
     };
 
-    return false;
+    for (const auto& v : val.GetArray()) {
+
+        if (v.IsDouble()) {
+            out.emplace_back(v.GetDouble());
+            continue;
+        };
+        if (v.IsInt()) {
+            out.emplace_back(v.GetInt());
+            continue;
+        };
+        throw libException(
+            FMT("Expected value({0})'s type wasn't the one expected (expected an array of doubles)", name));
+    };
 };
 
-inline bool _getIfExists(const rj::Value::Object& val, bool& out, const char* name) {
+// response structs, parsed with their own parse()
+template <typename T, typename = decltype(T::_fields)> void _assign(rj::Value& val, T& out, std::string_view name) {
 
-    auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
+    if (!val.IsObject()) {
+        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected an Object)", name));
+    };
+
+    out.parse(val.GetObject());
+};
+
+template <typename T, typename = decltype(T::_fields)>
+void _assign(rj::Value& val, std::vector<T>& out, std::string_view name) {
 
-        if (it->value.IsBool()) {
+    if (!val.IsArray()) {
+        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected an Array)", name));
+    };
 
-            out = it->value.GetBool();
-            return true;
+    out.reserve(out.size() + val.Size());
+    for (auto& v : val.GetArray()) {
+
+        if (!v.IsObject()) {
+            throw libException(
+                FMT("Expected value({0})'s type wasn't the one expected (expected an array of Objects)", name));
         };
-        throw libException(FMT("Expected value({0})'s type wasn't the one expected (expected a bool)", name));
+        out.emplace_back().parse(v.GetObject());
     };
+};
 
-    return false;
+template <typename T> bool _getIfExists(const rj::Value::Object& val, T& out, const char* name) {
+
+    auto it = val.FindMember(name);
+    if (it == val.MemberEnd()) { return false; };
+
+    _assign(it->value, out, name);
+    return true;
 };
 
-inline bool _getIfExists(const rj::Value::Object& val, std::vector<string>& out, const char* name) {
+inline bool _getIfExists(const rj::Document& val, string& out, const char* name) {
 
     auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
+    if (it == val.MemberEnd()) { return false; };
 
-        if (it->value.IsArray()) {
+    _assign(it->value, out, name);
+    return true;
+};
 
-            for (const auto& v : it->value.GetArray()) {
+template <typename T, size_t I> void _setField(T& obj, rj::Value& val) {
 
-                (v.IsString()) ?
-                    out.emplace_back(v.GetString()) :
-                    throw libException(
-                        FMT("Expected value({0})'s type wasn't the one expected (expected an array of strings)", name));
-            };
-            return true;
-        };
-        throw libException(
-            FMT("Expected value({0})'s type wasn't the one expected (expected an array of strings)", name));
+    const auto& field = std::get<I>(T::_fields);
+    _assign(val, field.of(obj), field.key);
+};
+
+// setters of T's fields, indexed like T::_fields
+template <typename T> struct _fieldSetters {
+
+    template <size_t... I> static constexpr auto make(std::index_sequence<I...> /*unused*/) {
+        return std::array<void (*)(T&, rj::Value&), sizeof...(I)> { &_setField<T, I>... };
     };
 
-    return false;
+    static constexpr auto table = make(std::make_index_sequence<_fieldTable<T>::size> {});
 };
 
-inline bool _getIfExists(const rj::Value::Object& val, std::vector<double>& out, const char* name) {
+/*
+ Parses an object into a struct that has a field table, in a single pass over the object's members. Members that aren't
+ fields of T are skipped. Returns a mask of the fields that were found (see kc::_fieldBit()).
+*/
+template <typename T> uint64_t _parseObject(T& obj, const rj::Value::Object& val) {
 
-    auto it = val.FindMember(name);
-    if (it != val.MemberEnd()) {
-
-        if (it->value.IsArray()) {
-
-            for (const auto& v : it->value.GetArray()) {
-
-                if (v.IsDouble()) {
-                    out.emplace_back(v.GetDouble());
-                    continue;
-                };
-                if (v.IsInt()) {
-                    out.emplace_back(v.GetInt());
-                    continue;
-                };
-                throw libException(
-                    FMT("Expected value({0})'s type wasn't the one expected (expected an array of doubles)", name));
-            };
+    using table = _fieldTable<T>;
+    static_assert(table::size <= 64, "_parseObject() supports structs with up to 64 fields");
 
-            return true;
-        };
-        throw libException(
-            FMT("Expected value({0})'s type wasn't the one expected (expected an array of double)", name));
+    uint64_t found = 0;
+    for (auto& member : val) {
+
+        const size_t idx = table::find(std::string_view(member.name.GetString(), member.name.GetStringLength()));
+        if (idx == table::size) { continue; };
+
+        _fieldSetters<T>::table[idx](obj, member.value);
+        found |= uint64_t(1) << idx;
     };
 
-    return false;
+    return found;
 };
 
 inline bool _getIfExists(const rj::Value::Object& val, rj::Value& out, const char* name, _RJValueType type) {
@@ -0,0 +1,412 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has a SAX parser that fills response structs straight from the JSON text, without building a DOM. Members
+// are matched to JSON keys through the field tables of the structs (see fieldtable.hpp)
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "config.hpp"
+#include "fieldtable.hpp"
+#include "kiteppexceptions.hpp"
+#include "rapidjson/error/en.h"
+#include "rapidjson/reader.h"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+namespace rj = rapidjson;
+
+// scalar JSON value passed to field setters
+struct _saxValue {
+
+    enum class types
+    {
+        NUL,
+        BOOL,
+        INT,
+        DOUBLE,
+        STRING
+    };
+
+    types type = types::NUL;
+    bool b = false;
+    int64_t i = 0;
+    double d = 0.0;
+    std::string_view str;
+};
+
+// setters return false if the value's type doesn't match the field's. Nulls leave numbers untouched and clear strings
+inline bool _saxAssign(string& out, const _saxValue& val) {
+
+    if (val.type == _saxValue::types::STRING) {
+        out.assign(val.str.data(), val.str.size());
+        return true;
+    };
+    if (val.type == _saxValue::types::NUL) {
+        out.clear();
+        return true;
+    };
+    return false;
+};
+
+// the view points into the JSON text, which is parsed in situ and has to outlive out
+inline bool _saxAssign(std::string_view& out, const _saxValue& val) {
+
+    if (val.type == _saxValue::types::STRING) {
+        out = val.str;
+        return true;
+    };
+    if (val.type == _saxValue::types::NUL) {
+        out = std::string_view();
+        return true;
+    };
+    return false;
+};
+
+inline bool _saxAssign(int& out, const _saxValue& val) {
+
+    if (val.type == _saxValue::types::INT && val.i >= std::numeric_limits<int>::min() &&
+        val.i <= std::numeric_limits<int>::max()) {
+        out = static_cast<int>(val.i);
+        return true;
+    };
+    return val.type == _saxValue::types::NUL;
+};
+
+inline bool _saxAssign(double& out, const _saxValue& val) {
+
+    if (val.type == _saxValue::types::DOUBLE) {
+        out = val.d;
+        return true;
+    };
+    if (val.type == _saxValue::types::INT) {
+        out = static_cast<double>(val.i);
+        return true;
+    };
+    return val.type == _saxValue::types::NUL;
+};
+
+inline bool _saxAssign(bool& out, const _saxValue& val) {
+
+    if (val.type == _saxValue::types::BOOL) {
+        out = val.b;
+        return true;
+    };
+    return val.type == _saxValue::types::NUL;
+};
+
+struct _saxOps;
+
+// an object or array being filled. Frames without obj are skipped along with everything in them
+struct _saxFrame {
+
+    void* obj = nullptr;
+    const _saxOps* ops = nullptr;
+};
+
+struct _saxOps {
+
+    // scalar value of a member (key is empty for array elements)
+    bool (*value)(void* obj, std::string_view key, const _saxValue& val);
+    // object or array value of a member
+    _saxFrame (*enter)(void* obj, std::string_view key, bool isArray);
+};
+
+template <typename T> struct _saxStructOps;
+template <typename T> struct _saxVectorOps;
+template <typename T> struct _saxMapOps;
+
+template <typename T> struct _saxIsScalar {
+
+    static constexpr bool value = std::is_same<T, string>::value || std::is_same<T, std::string_view>::value ||
+                                  std::is_same<T, int>::value || std::is_same<T, double>::value ||
+                                  std::is_same<T, bool>::value;
+};
+
+template <typename T> _saxFrame _saxFrameOf(T& obj, bool isArray) {
+    return (isArray) ? _saxFrame {} : _saxFrame { &obj, &_saxStructOps<T>::ops };
+};
+
+template <typename T> _saxFrame _saxFrameOf(std::vector<T>& vec, bool isArray) {
+    return (isArray) ? _saxFrame { &vec, &_saxVectorOps<T>::ops } : _saxFrame {};
+};
+
+template <typename T> _saxFrame _saxFrameOf(std::unordered_map<string, T>& map, bool isArray) {
+    return (isArray) ? _saxFrame {} : _saxFrame { &map, &_saxMapOps<T>::ops };
+};
+
+// scalar value of the I'th field of T
+template <typename T, size_t I> bool _saxSet(T& obj, const _saxValue& val) {
+
+    auto& member = std::get<I>(T::_fields).of(obj);
+    if constexpr (_saxIsScalar<std::remove_reference_t<decltype(member)>>::value) {
+        return _saxAssign(member, val);
+    } else {
+        // null in place of an object or array
+        return val.type == _saxValue::types::NUL;
+    };
+};
+
+// object or array value of the I'th field of T
+template <typename T, size_t I> _saxFrame _saxEnter(T& obj, bool isArray) {
+
+    auto& member = std::get<I>(T::_fields).of(obj);
+    if constexpr (_saxIsScalar<std::remove_reference_t<decltype(member)>>::value) {
+        return {};
+    } else {
+        return _saxFrameOf(member, isArray);
+    };
+};
+
+// field handlers of T, indexed like T::_fields
+template <typename T> struct _saxFields {
+
+    template <size_t... I> static constexpr auto setters(std::index_sequence<I...> /*unused*/) {
+        return std::array<bool (*)(T&, const _saxValue&), sizeof...(I)> { &_saxSet<T, I>... };
+    };
+
+    template <size_t... I> static constexpr auto enters(std::index_sequence<I...> /*unused*/) {
+        return std::array<_saxFrame (*)(T&, bool), sizeof...(I)> { &_saxEnter<T, I>... };
+    };
+
+    static constexpr auto set = setters(std::make_index_sequence<_fieldTable<T>::size> {});
+    static constexpr auto enter = enters(std::make_index_sequence<_fieldTable<T>::size> {});
+};
+
+template <typename T> struct _saxStructOps {
+
+    static bool value(void* obj, std::string_view key, const _saxValue& val) {
+
+        const size_t idx = _fieldTable<T>::find(key);
+        return (idx == _fieldTable<T>::size) || _saxFields<T>::set[idx](*static_cast<T*>(obj), val);
+    };
+
+    static _saxFrame enter(void* obj, std::string_view key, bool isArray) {
+
+        const size_t idx = _fieldTable<T>::find(key);
+        return (idx == _fieldTable<T>::size) ? _saxFrame {} : _saxFields<T>::enter[idx](*static_cast<T*>(obj), isArray);
+    };
+
+    static constexpr _saxOps ops { &value, &enter };
+};
+
+template <typename T> struct _saxVectorOps {
+
+    static bool value(void* obj, std::string_view /*key*/, const _saxValue& val) {
+
+        if constexpr (_saxIsScalar<T>::value) {
+            return _saxAssign(static_cast<std::vector<T>*>(obj)->emplace_back(), val);
+        } else {
+            return val.type == _saxValue::types::NUL;
+        };
+    };
+
+    static _saxFrame enter(void* obj, std::string_view /*key*/, bool isArray) {
+
+        if constexpr (_saxIsScalar<T>::value) {
+            return {};
+        } else {
+            auto& vec = *static_cast<std::vector<T>*>(obj);
+            return (isArray) ? _saxFrame {} : _saxFrameOf(vec.emplace_back(), false);
+        };
+    };
+
+    static constexpr _saxOps ops { &value, &enter };
+};
+
+template <typename T> struct _saxMapOps {
+
+    static bool value(void* /*obj*/, std::string_view /*key*/, const _saxValue& val) {
+        return val.type == _saxValue::types::NUL;
+    };
+
+    static _saxFrame enter(void* obj, std::string_view key, bool isArray) {
+        auto& map = *static_cast<std::unordered_map<string, T>*>(obj);
+        return (isArray) ? _saxFrame {} : _saxFrameOf(map[string(key)], false);
+    };
+
+    static constexpr _saxOps ops { &value, &enter };
+};
+
+// top level object of a response. Only `data` is parsed
+template <typename T> struct _saxRoot {
+
+    T* data = nullptr;
+    bool found = false;
+
+    static bool value(void* /*obj*/, std::string_view /*key*/, const _saxValue& /*val*/) { return true; };
+
+    static _saxFrame enter(void* obj, std::string_view key, bool isArray) {
+
+        auto& root = *static_cast<_saxRoot*>(obj);
+        if (key != "data") { return {}; };
+
+        _saxFrame frame = _saxFrameOf(*root.data, isArray);
+        root.found = frame.obj != nullptr;
+        return frame;
+    };
+
+    static constexpr _saxOps ops { &value, &enter };
+};
+
+class _saxHandler : public rj::BaseReaderHandler<rj::UTF8<>, _saxHandler> {
+
+  public:
+    explicit _saxHandler(_saxFrame root): _root(root) {};
+
+    string error;
+
+    bool StartObject() { return _start(false); };
+    bool EndObject(rj::SizeType /*memberCount*/) { return _end(); };
+    bool StartArray() { return _start(true); };
+    bool EndArray(rj::SizeType /*elementCount*/) { return _end(); };
+
+    bool Key(const char* str, rj::SizeType length, bool /*copy*/) {
+        if (_skip == 0) { _key = std::string_view(str, length); };
+        return true;
+    };
+
+    bool Null() { return _value({}); };
+
+    bool Bool(bool b) {
+        _saxValue val;
+        val.type = _saxValue::types::BOOL;
+        val.b = b;
+        return _value(val);
+    };
+
+    bool Int(int i) { return Int64(i); };
+    bool Uint(unsigned i) { return Int64(i); };
+
+    bool Int64(int64_t i) {
+        _saxValue val;
+        val.type = _saxValue::types::INT;
+        val.i = i;
+        return _value(val);
+    };
+
+    bool Uint64(uint64_t i) {
+        if (i > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) { return Double(static_cast<double>(i)); };
+        return Int64(static_cast<int64_t>(i));
+    };
+
+    bool Double(double d) {
+        _saxValue val;
+        val.type = _saxValue::types::DOUBLE;
+        val.d = d;
+        return _value(val);
+    };
+
+    bool String(const char* str, rj::SizeType length, bool /*copy*/) {
+        _saxValue val;
+        val.type = _saxValue::types::STRING;
+        val.str = std::string_view(str, length);
+        return _value(val);
+    };
+
+  private:
+    _saxFrame _root;
+    std::vector<_saxFrame> _stack;
+    size_t _skip = 0; // depth inside a skipped value
+    std::string_view _key;
+
+    bool _start(bool isArray) {
+
+        if (_skip > 0) {
+            _skip++;
+            return true;
+        };
+
+        if (_stack.empty()) {
+
+            if (isArray) {
+                error = "response isn't an object";
+                return false;
+            };
+            _stack.push_back(_root);
+            return true;
+        };
+
+        const _saxFrame& top = _stack.back();
+        _saxFrame frame = top.ops->enter(top.obj, _key, isArray);
+        if (frame.obj == nullptr) {
+            _skip = 1;
+        } else {
+            _stack.push_back(frame);
+        };
+        _key = std::string_view();
+        return true;
+    };
+
+    bool _end() {
+
+        if (_skip > 0) {
+            _skip--;
+        } else {
+            _stack.pop_back();
+        };
+        return true;
+    };
+
+    bool _value(const _saxValue& val) {
+
+        if (_skip > 0 || _stack.empty()) { return true; };
+
+        const _saxFrame& top = _stack.back();
+        if (!top.ops->value(top.obj, _key, val)) {
+            error = FMT("Expected value({0})'s type wasn't the one expected", _key);
+            return false;
+        };
+        return true;
+    };
+};
+
+/*
+ Parses `data` of a response into out. json is parsed in situ and is modified in the process. Members that don't map to
+ a field of the struct are skipped. Returns false if the response has no `data` of the expected type (an object for
+ structs and maps and an array for vectors). Throws libException if the JSON is malformed or a value has an unexpected
+ type.
+*/
+template <typename T> bool _saxParse(string& json, T& out) {
+
+    _saxRoot<T> root { &out, false };
+    _saxHandler handler({ &root, &_saxRoot<T>::ops });
+    rj::Reader reader;
+    rj::InsituStringStream stream(&json[0]);
+    if (reader.Parse<rj::kParseInsituFlag>(stream, handler).IsError()) {
+        throw libException(FMT("Failed to parse json string: {0}",
+            handler.error.empty() ? rj::GetParseError_En(reader.GetParseErrorCode()) : handler.error));
+    };
+
+    return root.found;
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,114 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has the snapshots kept up to date by `kite::syncOrders()` and `kite::syncTrades()`
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "rapidjson/document.h"
+#include "responses.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+namespace rj = rapidjson;
+
+/// orders of the day, updated in place by `kite::syncOrders()`
+struct orderSnapshot {
+
+    /// all orders seen so far. Orders are never removed or moved, so pointers to them stay valid
+    std::deque<order> orders;
+
+    /// orders that were added or changed by the last sync
+    std::vector<const order*> changed;
+
+    // order ID -> index in orders
+    std::unordered_map<string, size_t> _index;
+    // hashes of the key fields of orders, indexed like orders
+    std::vector<uint64_t> _hashes;
+};
+
+/// trades of the day, updated in place by `kite::syncTrades()`
+struct tradeSnapshot {
+
+    /// all trades seen so far. Trades are never removed or moved, so pointers to them stay valid
+    std::deque<trade> trades;
+
+    /// trades that were added by the last sync
+    std::vector<const trade*> added;
+
+    // trade ID -> index in trades
+    std::unordered_map<string, size_t> _index;
+};
+
+// string value of a member or an empty view if it isn't a string
+inline std::string_view _memberView(const rj::Value& obj, const char* name) {
+
+    auto it = obj.FindMember(name);
+    if (it == obj.MemberEnd() || !it->value.IsString()) { return {}; };
+
+    return { it->value.GetString(), it->value.GetStringLength() };
+};
+
+// hash of the members of an order that change along with its state. Orders with the same hash aren't parsed again
+inline uint64_t _orderHash(const rj::Value& obj) {
+
+    static constexpr const char* keys[] = { "order_id", "status", "exchange_update_timestamp", "filled_quantity",
+        "pending_quantity", "quantity", "price", "trigger_price" };
+
+    // 64-bit FNV-1a of all members
+    uint64_t hash = 0xCBF29CE484222325ull;
+    const auto fold = [&hash](const char* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            hash ^= static_cast<uint8_t>(data[i]);
+            hash *= 0x100000001B3ull;
+        };
+    };
+
+    for (const char* key : keys) {
+
+        auto it = obj.FindMember(key);
+        std::string_view bytes;
+        double num = 0.0;
+        if (it == obj.MemberEnd() || it->value.IsNull()) {
+            bytes = "\x01";
+        } else if (it->value.IsString()) {
+            bytes = { it->value.GetString(), it->value.GetStringLength() };
+        } else if (it->value.IsNumber()) {
+            num = it->value.GetDouble();
+            bytes = { reinterpret_cast<const char*>(&num), sizeof(num) };
+        };
+
+        // members are separated by their lengths so that e.g. status `OPEN` + `1` doesn't equal `OPEN1`
+        const uint64_t size = bytes.size();
+        fold(reinterpret_cast<const char*>(&size), sizeof(size));
+        fold(bytes.data(), bytes.size());
+    };
+
+    return hash;
+};
+
+} // namespace kiteconnect
@@ -0,0 +1,646 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file has the transports `kite` sends its requests through. Transports only move bytes; building requests and
+// parsing responses (including error responses) is done by `kite` regardless of the transport
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// the transports use OpenSSL directly, so httplib has to be built with it
+#ifndef CPPHTTPLIB_OPENSSL_SUPPORT
+#define CPPHTTPLIB_OPENSSL_SUPPORT
+#endif
+#include "cpp-httplib/httplib.h"
+
+#include "config.hpp"
+#include "kiteppexceptions.hpp"
+#include "metrics.hpp"
+
+namespace kiteconnect {
+
+using std::string;
+
+/// response received by a transport
+struct httpResponse {
+
+    httpResponse() = default;
+
+    httpResponse(int Code, string Body): code(Code), body(std::move(Body)) {};
+
+    int code = 0;
+    string body;
+    requestTimings timings;
+};
+
+/// numbers of TLS handshakes done by a transport
+struct handshakeCounts {
+
+    size_t full = 0;
+    size_t resumed = 0; // abbreviated handshakes that resumed an earlier session
+};
+
+/**
+ * @brief Interface of the transports `kite` can send requests through (see `kite::setTransport()`)
+ *
+ */
+class transport {
+
+  public:
+    // constructors and destructor
+
+    virtual ~transport() = default;
+
+    // methods
+
+    /**
+     * @brief send a request. Throws libException if the request couldn't be sent
+     *
+     * @param mtd method
+     * @param path path of the endpoint, including the query
+     * @param headers
+     * @param body body of POST and PUT requests
+     * @param contentType content type of the body
+     *
+     * @return httpResponse
+     */
+    virtual httpResponse send(const _methods& mtd, const char* path, const httplib::Headers& headers,
+        const string& body, const char* contentType) = 0;
+
+    /**
+     * @brief send a GET request and pass the body of a successful response to receiver chunk by chunk as it's
+     * received. Bodies of other responses are returned in the response. Throws libException if the request couldn't
+     * be sent
+     *
+     * @param path path of the endpoint, including the query
+     * @param headers
+     * @param receiver
+     *
+     * @return httpResponse
+     */
+    virtual httpResponse stream(const char* path, const httplib::Headers& headers,
+        const std::function<void(const char* data, size_t size)>& receiver) = 0;
+
+    /**
+     * @brief open connections ahead of the first request. Does nothing by default
+     *
+     */
+    virtual void warmup() {};
+
+    /**
+     * @brief get numbers of TLS handshakes done so far. Zero by default
+     *
+     * @return handshakeCounts
+     */
+    virtual handshakeCounts getHandshakeCounts() const { return {}; };
+};
+
+/**
+ * @brief Default transport, which sends requests with `httplib::Client`. It's final so that `kite` calls it directly
+ * when no other transport is set
+ *
+ * The connection is kept alive between requests and TLS sessions are resumed when it has to be opened again, so only
+ * the first connection pays for a full handshake. `warmup()` opens the connection ahead of the first request and
+ * `startHeartbeat()` keeps it from being closed by the server while it's idle.
+ *
+ * Phases of requests are timed through callbacks of the SSL objects: the handshake for the connect and TLS phases and
+ * the application data records for the write, first byte and read phases.
+ */
+class httpTransport final : public transport {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new httpTransport object
+     *
+     * @param rootURL scheme and host requests are sent to
+     */
+    explicit httpTransport(const string& rootURL): _client(rootURL.c_str()) {
+
+        _client.set_keep_alive(true);
+        // httplib writes the headers and the body of a request separately. Nagle would hold the body back until the
+        // headers are acknowledged, which the server delays
+        _client.set_tcp_nodelay(true);
+
+        // httplib creates the SSL objects itself, so sessions are saved and set through callbacks of its context
+        SSL_CTX* ctx = _client.ssl_context();
+        if (ctx == nullptr) { return; };
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+        SSL_CTX_set_ex_data(ctx, _exIndex(), this);
+        SSL_CTX_sess_set_new_cb(ctx, &_onNewSession);
+        SSL_CTX_set_info_callback(ctx, &_onInfo);
+        SSL_CTX_set_msg_callback(ctx, &_onMessage);
+    };
+
+    httpTransport(const httpTransport&) = delete;
+    httpTransport& operator=(const httpTransport&) = delete;
+
+    ~httpTransport() override {
+
+        stopHeartbeat();
+        if (SSL_CTX* ctx = _client.ssl_context()) {
+            SSL_CTX_sess_set_new_cb(ctx, nullptr);
+            SSL_CTX_set_info_callback(ctx, nullptr);
+            SSL_CTX_set_msg_callback(ctx, nullptr);
+        };
+        if (_session != nullptr) { SSL_SESSION_free(_session); };
+    };
+
+    // methods
+
+    httpResponse send(const _methods& mtd, const char* path, const httplib::Headers& headers, const string& body,
+        const char* contentType) override {
+
+        const int64_t start = _touch();
+        std::lock_guard<std::mutex> lock(_requestMtx);
+        _trace trace(start);
+
+        httpResponse res = _send(mtd, path, headers, body, contentType);
+        res.timings = trace.timings();
+        return res;
+    };
+
+    httpResponse stream(const char* path, const httplib::Headers& headers,
+        const std::function<void(const char* data, size_t size)>& receiver) override {
+
+        const int64_t start = _touch();
+        std::lock_guard<std::mutex> lock(_requestMtx);
+        _trace trace(start);
+
+        httpResponse response;
+        auto res = _client.Get(
+            path, headers,
+            [&response](const httplib::Response& head) {
+                response.code = head.status;
+                return true;
+            },
+            [&](const char* data, size_t size) {
+                (response.code == 200) ? receiver(data, size) : static_cast<void>(response.body.append(data, size));
+                return true;
+            });
+
+        if (!res) { throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error())); };
+
+        response.timings = trace.timings();
+        return response;
+    };
+
+    /**
+     * @brief open the connection (or check that it's still open) by sending a HEAD request. Throws libException if
+     * the request couldn't be sent
+     *
+     */
+    void warmup() override {
+
+        _touch();
+        std::lock_guard<std::mutex> lock(_requestMtx);
+        _take(_client.Head("/"));
+    };
+
+    handshakeCounts getHandshakeCounts() const override { return { _fullHandshakes, _resumedHandshakes }; };
+
+    /**
+     * @brief start sending a HEAD request whenever the connection has been idle for an interval, so that the server
+     * doesn't close it. Failed heartbeats are ignored; the connection is opened again by the next request
+     *
+     * @param interval should be shorter than the server's keep-alive timeout
+     */
+    void startHeartbeat(std::chrono::milliseconds interval) {
+
+        stopHeartbeat();
+
+        _stopHeartbeat = false;
+        _heartbeat = std::thread([this, interval]() {
+            std::unique_lock<std::mutex> lock(_heartbeatMtx);
+            while (!_stopHeartbeat) {
+
+                // waits only for the rest of the interval, so the connection is never idle for longer than interval
+                const std::chrono::nanoseconds idle = _idle();
+                if (idle < interval) {
+                    _heartbeatCv.wait_for(lock, interval - idle, [this]() { return _stopHeartbeat; });
+                    continue;
+                };
+                lock.unlock();
+                try {
+                    warmup();
+                } catch (const std::exception&) {};
+                lock.lock();
+            };
+        });
+    };
+
+    /**
+     * @brief stop sending heartbeats
+     *
+     */
+    void stopHeartbeat() {
+
+        {
+            std::lock_guard<std::mutex> lock(_heartbeatMtx);
+            _stopHeartbeat = true;
+        };
+        _heartbeatCv.notify_all();
+        if (_heartbeat.joinable()) { _heartbeat.join(); };
+    };
+
+    /**
+     * @brief get the underlying client, e.g. for setting timeouts
+     *
+     * @return httplib::Client&
+     */
+    httplib::Client& getClient() { return _client; };
+
+  private:
+    // timestamps of the request the calling thread is sending, set by the SSL callbacks
+    struct _trace {
+
+        int64_t start = 0;
+        int64_t ready = 0; // when the connection was free
+        int64_t TLSStart = 0;
+        int64_t TLSDone = 0;
+        int64_t lastWrite = 0;
+        int64_t firstRead = 0;
+
+        explicit _trace(int64_t Start): start(Start), ready(_steadyNs()) { active() = this; };
+        _trace(const _trace&) = delete;
+        _trace& operator=(const _trace&) = delete;
+        ~_trace() { active() = nullptr; };
+
+        static _trace*& active() {
+            thread_local _trace* trace = nullptr;
+            return trace;
+        };
+
+        requestTimings timings() const {
+
+            requestTimings timings;
+            const int64_t end = _steadyNs();
+            timings.wait = ready - start;
+
+            // a connection was opened if there was a handshake
+            int64_t sent = ready;
+            if (TLSStart != 0 && TLSDone != 0) {
+                timings.connect = TLSStart - ready;
+                timings.TLS = TLSDone - TLSStart;
+                sent = TLSDone;
+            };
+            if (firstRead == 0) {
+                timings.firstByte = end - sent;
+                return timings;
+            };
+
+            const int64_t written = (lastWrite != 0) ? lastWrite : sent;
+            timings.write = written - sent;
+            timings.firstByte = firstRead - written;
+            timings.read = end - firstRead;
+            return timings;
+        };
+    };
+
+    // member variables
+
+    std::mutex _requestMtx; // httplib sends one request at a time too; waiting for this is the wait phase
+
+    // declared before the client, whose SSL objects may call the callbacks until it's destroyed
+    std::mutex _sessionMtx;
+    SSL_SESSION* _session = nullptr; // last session received, resumed by the next connection
+    std::atomic<size_t> _fullHandshakes { 0 };
+    std::atomic<size_t> _resumedHandshakes { 0 };
+    std::atomic<int64_t> _lastUse { 0 }; // steady clock, in nanoseconds
+
+    std::thread _heartbeat;
+    std::mutex _heartbeatMtx;
+    std::condition_variable _heartbeatCv;
+    bool _stopHeartbeat = false;
+
+    httplib::Client _client;
+
+    // methods
+
+    httpResponse _send(const _methods& mtd, const char* path, const httplib::Headers& headers, const string& body,
+        const char* contentType) {
+
+        switch (mtd) {
+            case _methods::GET: return _take(_client.Get(path, headers));
+            case _methods::POST: return _take(_client.Post(path, headers, body, contentType));
+            case _methods::PUT: return _take(_client.Put(path, headers, body, contentType));
+            case _methods::DEL: return _take(_client.Delete(path, headers));
+            case _methods::HEAD: return _take(_client.Head(path, headers));
+        };
+
+        throw libException("Unknown method (httpTransport)");
+    };
+
+    static httpResponse _take(httplib::Result res) {
+
+        if (!res) { throw libException(FMT("Failed to send http/https request (enum code: {0})", res.error())); };
+
+        return { res->status, std::move(res->body) };
+    };
+
+    int64_t _touch() {
+
+        const int64_t now = _steadyNs();
+        _lastUse = now;
+        return now;
+    };
+
+    std::chrono::nanoseconds _idle() const {
+        return std::chrono::steady_clock::now().time_since_epoch() - std::chrono::nanoseconds(_lastUse.load());
+    };
+
+    static int _exIndex() {
+
+        static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+        return index;
+    };
+
+    static httpTransport* _of(const SSL* ssl) {
+        return static_cast<httpTransport*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), _exIndex()));
+    };
+
+    // keeps the newest session. TLS 1.3 sends its tickets after the handshake, so this can be called more than once
+    static int _onNewSession(SSL* ssl, SSL_SESSION* session) {
+
+        httpTransport* self = _of(ssl);
+        if (self == nullptr) { return 0; };
+
+        std::lock_guard<std::mutex> lock(self->_sessionMtx);
+        if (self->_session != nullptr) { SSL_SESSION_free(self->_session); };
+        self->_session = session;
+        return 1; // keeps the reference
+    };
+
+    // sets the saved session on new connections before the client hello is sent and counts finished handshakes
+    static void _onInfo(const SSL* constSSL, int where, int /*ret*/) {
+
+        httpTransport* self = _of(constSSL);
+        if (self == nullptr) { return; };
+        SSL* ssl = const_cast<SSL*>(constSSL);
+
+        _trace* trace = _trace::active();
+
+        if ((where & SSL_CB_HANDSHAKE_START) != 0 && SSL_get_session(ssl) == nullptr) {
+
+            if (trace != nullptr) { trace->TLSStart = _steadyNs(); };
+            std::lock_guard<std::mutex> lock(self->_sessionMtx);
+            if (self->_session != nullptr) { SSL_set_session(ssl, self->_session); };
+        } else if ((where & SSL_CB_HANDSHAKE_DONE) != 0) {
+
+            if (trace != nullptr) { trace->TLSDone = _steadyNs(); };
+            (SSL_session_reused(ssl) != 0) ? self->_resumedHandshakes++ : self->_fullHandshakes++;
+        };
+    };
+
+    // notes when the request was written and when the response started arriving. TLS 1.3 encrypts the record type, so
+    // the inner type is used for it
+    static void _onMessage(
+        int writeP, int /*version*/, int contentType, const void* buf, size_t len, SSL* ssl, void* /*arg*/) {
+
+        _trace* trace = _trace::active();
+        if (trace == nullptr || len == 0 || trace->firstRead != 0) { return; };
+
+        const bool TLS13 = SSL_version(ssl) == TLS1_3_VERSION;
+        if (contentType != (TLS13 ? SSL3_RT_INNER_CONTENT_TYPE : SSL3_RT_HEADER)) { return; };
+        if (static_cast<const unsigned char*>(buf)[0] != SSL3_RT_APPLICATION_DATA) { return; };
+
+        if (writeP != 0) {
+            trace->lastWrite = _steadyNs();
+        } else {
+            trace->firstRead = _steadyNs();
+        };
+    };
+};
+
+/**
+ * @brief Transport that answers from responses set beforehand, without any I/O. Meant for benchmarks and tests
+ *
+ * Requests without a response get a 404 `GeneralException` error response.
+ */
+class memoryTransport final : public transport {
+
+  public:
+    // methods
+
+    /**
+     * @brief set the response to requests with a method and path
+     *
+     * @param mtd method
+     * @param path path of the endpoint, including the query
+     * @param code status code
+     * @param body
+     */
+    void respond(const _methods& mtd, const string& path, int code, string body) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        _responses[_key(mtd, path)] = { code, std::move(body) };
+    };
+
+    /**
+     * @brief get number of requests received so far
+     *
+     * @return size_t
+     */
+    size_t getRequestCount() const {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _requests;
+    };
+
+    httpResponse send(const _methods& mtd, const char* path, const httplib::Headers& /*headers*/,
+        const string& /*body*/, const char* /*contentType*/) override {
+        return _find(mtd, path);
+    };
+
+    httpResponse stream(const char* path, const httplib::Headers& /*headers*/,
+        const std::function<void(const char* data, size_t size)>& receiver) override {
+
+        httpResponse res = _find(_methods::GET, path);
+        if (res.code == 200) {
+            receiver(res.body.data(), res.body.size());
+            res.body.clear();
+        };
+
+        return res;
+    };
+
+  private:
+    // member variables
+
+    mutable std::mutex _mtx;
+    std::unordered_map<string, httpResponse> _responses;
+    size_t _requests = 0;
+
+    // methods
+
+    static string _key(const _methods& mtd, std::string_view path) {
+
+        string key(1, static_cast<char>('0' + static_cast<int>(mtd)));
+        key.append(path);
+        return key;
+    };
+
+    httpResponse _find(const _methods& mtd, const char* path) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        _requests++;
+        auto it = _responses.find(_key(mtd, path));
+        if (it == _responses.end()) {
+            return { 404, R"({"status":"error","error_type":"GeneralException","message":"No response was set"})" };
+        };
+
+        return it->second;
+    };
+};
+
+/**
+ * @brief Transport that records the requests sent through another transport along with their responses, or replays
+ * recorded ones in the same order without any I/O
+ *
+ */
+class recordingTransport final : public transport {
+
+  public:
+    /// a request and its response
+    struct exchange {
+
+        _methods method = _methods::GET;
+        string path;
+        string body;
+        httpResponse response;
+    };
+
+    // constructors and destructor
+
+    /**
+     * @brief Construct a recordingTransport that records
+     *
+     * @param upstream transport requests are sent through
+     */
+    explicit recordingTransport(std::unique_ptr<transport> upstream): _upstream(std::move(upstream)) {
+        if (!_upstream) { throw libException("Upstream transport can't be null (recordingTransport)"); };
+    };
+
+    /**
+     * @brief Construct a recordingTransport that replays
+     *
+     * @param recorded exchanges to replay, in order
+     */
+    explicit recordingTransport(std::vector<exchange> recorded): _exchanges(std::move(recorded)) {};
+
+    // methods
+
+    /**
+     * @brief get exchanges recorded so far (or the ones being replayed)
+     *
+     * @return std::vector<exchange>
+     */
+    std::vector<exchange> getExchanges() const {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        return _exchanges;
+    };
+
+    httpResponse send(const _methods& mtd, const char* path, const httplib::Headers& headers, const string& body,
+        const char* contentType) override {
+
+        if (!_upstream) { return _replay(mtd, path); };
+
+        httpResponse res = _upstream->send(mtd, path, headers, body, contentType);
+        _record(mtd, path, body, res);
+        return res;
+    };
+
+    httpResponse stream(const char* path, const httplib::Headers& headers,
+        const std::function<void(const char* data, size_t size)>& receiver) override {
+
+        if (!_upstream) {
+
+            httpResponse res = _replay(_methods::GET, path);
+            if (res.code == 200) {
+                receiver(res.body.data(), res.body.size());
+                res.body.clear();
+            };
+            return res;
+        };
+
+        string received;
+        httpResponse res = _upstream->stream(path, headers, [&](const char* data, size_t size) {
+            received.append(data, size);
+            receiver(data, size);
+        });
+        _record(_methods::GET, path, "", (res.code == 200) ? httpResponse { res.code, std::move(received) } : res);
+        return res;
+    };
+
+    void warmup() override {
+        if (_upstream) { _upstream->warmup(); };
+    };
+
+    handshakeCounts getHandshakeCounts() const override {
+        return (_upstream) ? _upstream->getHandshakeCounts() : handshakeCounts {};
+    };
+
+  private:
+    // member variables
+
+    std::unique_ptr<transport> _upstream;
+    mutable std::mutex _mtx;
+    std::vector<exchange> _exchanges;
+    size_t _next = 0; // next exchange to replay
+
+    // methods
+
+    void _record(const _methods& mtd, const char* path, const string& body, const httpResponse& res) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        _exchanges.push_back({ mtd, path, body, res });
+    };
+
+    httpResponse _replay(const _methods& mtd, const char* path) {
+
+        std::lock_guard<std::mutex> lock(_mtx);
+        if (_next >= _exchanges.size()) {
+            throw libException(FMT("No recorded exchanges are left to replay ({0})", path));
+        };
+        const exchange& ex = _exchanges[_next];
+        if (ex.method != mtd || ex.path != path) {
+            throw libException(FMT("Request doesn't match the recorded one ({0} was expected, {1} was sent)", ex.path,
+                path));
+        };
+        _next++;
+
+        return ex.response;
+    };
+};
+
+} // namespace kiteconnect
@@ -16,7 +16,9 @@
  */
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace kiteconnect {
@@ -38,4 +40,120 @@ std::vector<string> _split(const std::string& text, char sep) {
     return tokens;
 };
 
+// days since 1970-01-01 for a proleptic gregorian date. Based on Howard Hinnant's `days_from_civil()`
+inline int32_t _daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+
+    y -= (m <= 2) ? 1 : 0;
+    const int32_t era = (y >= 0 ? y : y - 399) / 400;
+    const uint32_t yoe = static_cast<uint32_t>(y - era * 400);
+    const uint32_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + static_cast<int32_t>(doe) - 719468;
+};
+
+// inverse of _daysFromCivil(). Returns date as yyyymmdd
+inline uint32_t _civilFromDays(int32_t z) {
+
+    z += 719468;
+    const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const uint32_t doe = static_cast<uint32_t>(z - era * 146097);
+    const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const uint32_t mp = (5 * doy + 2) / 153;
+    const uint32_t d = doy - (153 * mp + 2) / 5 + 1;
+    const uint32_t m = mp < 10 ? mp + 3 : mp - 9;
+    const int32_t y = static_cast<int32_t>(yoe) + era * 400 + (m <= 2 ? 1 : 0);
+
+    return static_cast<uint32_t>(y) * 10000 + m * 100 + d;
+};
+
+// parses n digits starting at str[pos]. Returns -1 if any of them isn't a digit
+inline int32_t _parseDigits(std::string_view str, size_t pos, size_t n) {
+
+    if (pos + n > str.size()) { return -1; };
+
+    int32_t out = 0;
+    for (size_t i = pos; i < pos + n; i++) {
+
+        const char c = str[i];
+        if (c < '0' || c > '9') { return -1; };
+        out = out * 10 + (c - '0');
+    };
+
+    return out;
+};
+
+// parses a yyyy-mm-dd date into days since 1970-01-01. Returns false if str isn't a valid date
+inline bool _parseDate(std::string_view str, int32_t& days) {
+
+    if (str.size() < 10 || str[4] != '-' || str[7] != '-') { return false; };
+
+    const int32_t y = _parseDigits(str, 0, 4);
+    const int32_t m = _parseDigits(str, 5, 2);
+    const int32_t d = _parseDigits(str, 8, 2);
+    if (y < 0 || m < 1 || m > 12 || d < 1 || d > 31) { return false; };
+
+    days = _daysFromCivil(y, static_cast<uint32_t>(m), static_cast<uint32_t>(d));
+    return true;
+};
+
+// parses an ISO 8601 timestamp (yyyy-mm-ddThh:mm:ss[.fff][Z|+hhmm|+hh:mm]) into nanoseconds since the unix epoch.
+// Timestamps without an offset are treated as UTC. Returns false if str isn't a valid timestamp
+inline bool _parseISO8601(std::string_view str, int64_t& ns) {
+
+    int32_t days = 0;
+    if (!_parseDate(str, days)) { return false; };
+    if (str.size() < 19 || (str[10] != 'T' && str[10] != ' ') || str[13] != ':' || str[16] != ':') { return false; };
+
+    const int32_t h = _parseDigits(str, 11, 2);
+    const int32_t m = _parseDigits(str, 14, 2);
+    const int32_t s = _parseDigits(str, 17, 2);
+    if (h < 0 || h > 23 || m < 0 || m > 59 || s < 0 || s > 60) { return false; };
+
+    size_t pos = 19;
+    int64_t fraction = 0;
+    if (pos < str.size() && str[pos] == '.') {
+
+        int64_t scale = 1000000000;
+        for (pos++; pos < str.size() && str[pos] >= '0' && str[pos] <= '9'; pos++) {
+            scale /= 10;
+            fraction += (str[pos] - '0') * scale;
+        };
+    };
+
+    int32_t offset = 0; // seconds east of UTC
+    if (pos < str.size() && str[pos] == 'Z') {
+        pos++;
+    } else if (pos < str.size() && (str[pos] == '+' || str[pos] == '-')) {
+
+        const int32_t sign = (str[pos] == '-') ? -1 : 1;
+        const int32_t oh = _parseDigits(str, pos + 1, 2);
+        pos += 3;
+        if (pos < str.size() && str[pos] == ':') { pos++; };
+        const int32_t om = _parseDigits(str, pos, 2);
+        pos += 2;
+        if (oh < 0 || om < 0) { return false; };
+        offset = sign * (oh * 3600 + om * 60);
+    };
+    if (pos != str.size()) { return false; };
+
+    const int64_t seconds = static_cast<int64_t>(days) * 86400 + h * 3600 + m * 60 + s - offset;
+    ns = seconds * 1000000000 + fraction;
+    return true;
+};
+
+// formats days since 1970-01-01 as yyyy-mm-dd
+inline string _formatDate(int32_t days) {
+
+    uint32_t ymd = _civilFromDays(days);
+    string out = "0000-00-00";
+    for (size_t i : { 9, 8, 6, 5, 3, 2, 1, 0 }) {
+        out[i] = static_cast<char>('0' + ymd % 10);
+        ymd /= 10;
+    };
+
+    return out;
+};
+
 } // namespace kiteconnect
\ No newline at end of file
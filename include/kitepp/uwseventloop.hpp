@@ -0,0 +1,136 @@
+/*
+ *   Copyright (c) 2020 Bhumit Attarde
+
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// this file runs `asyncClient` on the uWS loop `kiteWS` runs on, so that REST requests made from tick callbacks don't
+// block tick ingestion and don't need threads of their own
+
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "asyncclient.hpp"
+#include "kitews.hpp"
+#include <uWS/uWS.h>
+
+namespace kiteconnect {
+
+/**
+ * @brief `eventLoop` backed by a uWS loop (epoll or libuv, whichever uWS was built with)
+ *
+ * @paragraph ex1 Example
+ * @code
+ * kc::uwsEventLoop loop(ws);
+ * kc::asyncClient client(Kite, loop);
+ * client.connect();
+ * ws.onTicks = [&](kc::kiteWS* ws, const std::vector<kc::tick>& ticks) {
+ *     client.placeOrder(ord, 1, ticks[0].lastPrice, kc::DEFAULTDOUBLE, [](const string& ordID, auto error) {});
+ * };
+ * ws.run();
+ * @endcode
+ */
+class uwsEventLoop final : public eventLoop {
+
+  public:
+    // constructors and destructor
+
+    /**
+     * @brief Construct a new uwsEventLoop object
+     *
+     * @param loop
+     */
+    explicit uwsEventLoop(uS::Loop* loop): _loop(loop) {};
+
+    /**
+     * @brief Construct a new uwsEventLoop object that uses the loop of a kiteWS object
+     *
+     * @param ws
+     */
+    explicit uwsEventLoop(kiteWS& ws): _loop(ws.getLoop()) {};
+
+    uwsEventLoop(const uwsEventLoop&) = delete;
+    uwsEventLoop& operator=(const uwsEventLoop&) = delete;
+
+    ~uwsEventLoop() override {
+        for (auto& poll : _polls) { poll.second->halt(_loop); };
+    };
+
+    // methods
+
+    void watch(int fd, int events, std::function<void(int events)> cb) override {
+
+        auto* poll = new _poll(_loop, fd, std::move(cb));
+        poll->begin(_loop, _toUV(events));
+        _polls[fd] = poll;
+    };
+
+    void change(int fd, int events) override {
+
+        auto it = _polls.find(fd);
+        if (it != _polls.end()) { it->second->modify(_loop, _toUV(events)); };
+    };
+
+    void unwatch(int fd) override {
+
+        auto it = _polls.find(fd);
+        if (it == _polls.end()) { return; };
+        it->second->halt(_loop);
+        _polls.erase(it);
+    };
+
+  private:
+    // the members of uS::Poll are protected, so they're reached through these wrappers
+    struct _poll: public uS::Poll {
+
+        _poll(uS::Loop* loop, int fd, std::function<void(int events)> callback)
+            : uS::Poll(loop, fd), cb(std::move(callback)) {
+
+            setCb([](uS::Poll* p, int status, int events) {
+                int evs = (status < 0) ? eventLoop::FAILED : 0;
+                if ((events & UV_READABLE) != 0) { evs |= eventLoop::READABLE; };
+                if ((events & UV_WRITABLE) != 0) { evs |= eventLoop::WRITABLE; };
+                static_cast<_poll*>(p)->cb(evs);
+            });
+        };
+
+        void begin(uS::Loop* loop, int events) { start(loop, this, events); };
+
+        void modify(uS::Loop* loop, int events) { change(loop, this, events); };
+
+        // deletion is deferred by the loop, so this is safe to call from the callback
+        void halt(uS::Loop* loop) {
+            stop(loop);
+            close(loop, [](uS::Poll* p) { delete static_cast<_poll*>(p); });
+        };
+
+        std::function<void(int events)> cb;
+    };
+
+    // member variables
+
+    uS::Loop* _loop;
+    std::unordered_map<int, _poll*> _polls;
+
+    // methods
+
+    static int _toUV(int events) {
+        return (((events & READABLE) != 0) ? UV_READABLE : 0) | (((events & WRITABLE) != 0) ? UV_WRITABLE : 0);
+    };
+};
+
+} // namespace kiteconnect